@@ -0,0 +1,123 @@
+/**
+ * Project: VRPAntColony
+ * @file benchKernels.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Benchmark of vectorized edge kernels on large synthetic instances.
+ */
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include "../src/Kernels.h"
+
+/**
+ * Edge data of synthetic instance with uniformly distributed customers.
+ */
+struct Instance{
+	std::vector<double> d0;	//! distances to depot
+	std::vector<double> dist;	//! distances of arcs (row by row)
+	std::vector<unsigned> rowStart;	//! index of first arc of each row
+};
+
+Instance generate(const unsigned n, const unsigned seed){
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<unsigned> coord(0, 1000);
+	std::vector<double> x(n), y(n);
+	for(unsigned i=0; i<n; i++){
+		x[i]=coord(gen);
+		y[i]=coord(gen);
+	}
+
+	Instance inst;
+	inst.d0.resize(n);
+	inst.rowStart.resize(n);
+	inst.dist.reserve(static_cast<std::size_t>(n)*(n-1)/2);
+	for(unsigned i=0; i<n; i++){
+		inst.d0[i]=std::hypot(x[i]-x[0], y[i]-y[0]);
+		inst.rowStart[i]=inst.dist.size();
+		for(unsigned j=i+1; j<n; j++){
+			inst.dist.push_back(std::hypot(x[i]-x[j], y[i]-y[j]));
+		}
+	}
+	return inst;
+}
+
+/**
+ * Measures average time of given function in milliseconds.
+ */
+template<typename F>
+double measure(const unsigned repeats, F f){
+	auto start=std::chrono::steady_clock::now();
+	for(unsigned r=0; r<repeats; r++) f();
+	std::chrono::duration<double, std::milli> d=std::chrono::steady_clock::now()-start;
+	return d.count()/repeats;
+}
+
+/**
+ * Entry point of the benchmark.
+ *
+ * @param[in] argc
+ * 	Number of arguments.
+ * @param[in] argv
+ * 	Arguments: [number of vertices] [repeats]
+ * @return Exits codes.
+ */
+int main(int argc, char* argv[]){
+	const unsigned n=argc>1 ? std::strtoul(argv[1], nullptr, 10) : 3000;
+	const unsigned repeats=argc>2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+	if(n<2 || repeats==0){
+		std::cerr << "Usage: " << argv[0] << " [number of vertices] [repeats]" << std::endl;
+		return 1;
+	}
+
+	Instance inst=generate(n, 42);
+	const std::size_t m=inst.dist.size();
+	std::cout << "vertices: " << n << " arcs: " << m << " repeats: " << repeats << std::endl;
+
+	std::vector<double> vis(m), tau(m, 100), choice(m);
+	std::vector<double> reference;
+	double scalarTimes[3]={0, 0, 0};
+
+	const Kernels::Isa isas[]={Kernels::Isa::SCALAR, Kernels::Isa::AVX2, Kernels::Isa::AVX512};
+	for(Kernels::Isa isa : isas){
+		if(!Kernels::setIsa(isa)){
+			std::cout << Kernels::isaName(isa) << ": not supported" << std::endl;
+			continue;
+		}
+
+		double times[3];
+		times[0]=measure(repeats, [&](){
+			double visMin=std::numeric_limits<double>::infinity();
+			for(unsigned i=0; i+1<n; i++){
+				visMin=std::min(visMin, Kernels::savings(&inst.d0[i+1], &inst.dist[inst.rowStart[i]],
+						inst.d0[i], 2, 2, &vis[inst.rowStart[i]], n-i-1));
+			}
+			Kernels::shiftPow(vis.data(), m, (-visMin)+1, 5);
+		});
+		times[1]=measure(repeats, [&](){
+			Kernels::scale(tau.data(), m, 0.75);
+		});
+		std::fill(tau.begin(), tau.end(), 100);
+		times[2]=measure(repeats, [&](){
+			Kernels::choiceInfo(tau.data(), vis.data(), 5, choice.data(), m);
+		});
+
+		if(isa==Kernels::Isa::SCALAR){
+			reference=choice;
+			std::copy(times, times+3, scalarTimes);
+		}
+
+		std::cout << Kernels::isaName(isa) << (choice==reference ? "" : " (RESULTS DIFFER)") << std::endl;
+		const char* names[]={"visibility", "evaporation", "choice info"};
+		for(unsigned k=0; k<3; k++){
+			std::cout << "\t" << names[k] << ": " << times[k] << " ms (speedup " << scalarTimes[k]/times[k] << "x)" << std::endl;
+		}
+	}
+	return 0;
+}
+
+/*** End of file: benchKernels.cpp ***/
@@ -0,0 +1,297 @@
+/**
+ * Project: VRPAntColony
+ * @file vrpgen.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Generator of synthetic vehicle routing problems for scale and memory benchmarks.
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <cerrno>
+#include "../src/VRP.h"
+
+/**
+ * Layout of customers.
+ */
+enum class Layout{
+	UNIFORM,	//! Uniformly over the whole area.
+	CLUSTERED,	//! Normally around random centers.
+	MIXED		//! Half uniform and half clustered.
+};
+
+/**
+ * Distribution of demands.
+ */
+enum class Demand{
+	UNIFORM,	//! Uniform in [1, 2*mean-1].
+	NORMAL,		//! Normal with standard deviation mean/3.
+	EXPONENTIAL	//! Exponential with given mean.
+};
+
+/**
+ * Parameters of generated problem.
+ */
+struct Parameters{
+	unsigned long customers=1000;
+	unsigned seed=1;
+	Layout layout=Layout::UNIFORM;
+	unsigned clusters=0;	//! Zero means one cluster per 100 customers.
+	unsigned size=1000;	//! Side of square area.
+	unsigned capacity=200;
+	Demand demand=Demand::UNIFORM;
+	double meanDemand=20;
+	unsigned maxRouteTime=999999;	//! The same value as in benchmarks without route time limit.
+	double relativeRouteTime=0;	//! Maximum route time relative to trip to the farthest corner. Zero means unused.
+	unsigned dropTime=0;
+	bool binary=false;
+};
+
+/**
+ * Buffered writer of numbers. Problem is streamed, so memory does not depend on its size.
+ */
+class Writer{
+public:
+	Writer(std::FILE* f, const bool binary) :file(f), binary(binary) {
+		buffer.reserve(CAPACITY);
+	}
+
+	~Writer(){
+		flush();
+	}
+
+	/**
+	 * Writes number (text format separates numbers with space).
+	 */
+	void number(std::uint32_t n){
+		if(binary){
+			for (unsigned b = 0; b < 4; b++, n>>=8) buffer.push_back(static_cast<char>(n&0xff));
+		}else{
+			char digits[10];
+			unsigned count=0;
+			do{
+				digits[count++]='0'+n%10;
+				n/=10;
+			}while(n>0);
+			buffer.push_back(' ');
+			while(count>0) buffer.push_back(digits[--count]);
+		}
+		if(buffer.size()>=CAPACITY-16) flush();
+	}
+
+	/**
+	 * Ends line of text format.
+	 */
+	void endLine(){
+		if(!binary) buffer.push_back('\n');
+	}
+
+	void flush(){
+		if(!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file)!=buffer.size()) failed=true;
+		buffer.clear();
+	}
+
+	bool good() const {
+		return !failed;
+	}
+
+private:
+	static constexpr std::size_t CAPACITY=1<<20;
+
+	std::FILE* file;
+	bool binary;
+	bool failed=false;
+	std::vector<char> buffer;
+};
+
+/**
+ * Generates problem.
+ *
+ * @param[in] p
+ * 	Parameters of problem.
+ * @param[in] out
+ * 	Output.
+ */
+static void generate(const Parameters& p, Writer& out){
+	std::mt19937 gen(p.seed);
+	std::uniform_real_distribution<double> unit(0, 1);
+	auto clamp=[&p](const double v) -> std::uint32_t{
+		return static_cast<std::uint32_t>(std::min<double>(p.size, std::max(0.0, std::round(v))));
+	};
+
+	//depot is in the middle of area
+	const std::uint32_t depot=p.size/2;
+	unsigned maxRouteTime=p.maxRouteTime;
+	if(p.relativeRouteTime>0){
+		const double farthest=std::sqrt(2.0)*(p.size-depot);
+		maxRouteTime=static_cast<unsigned>(std::ceil(p.relativeRouteTime*(2*farthest+p.dropTime)));
+	}
+
+	//centers of clusters
+	const unsigned clusters=p.clusters>0 ? p.clusters : std::max<unsigned long>(1, p.customers/100);
+	std::vector<double> cx(clusters), cy(clusters);
+	for (unsigned c = 0; c < clusters; c++) {
+		cx[c]=unit(gen)*p.size;
+		cy[c]=unit(gen)*p.size;
+	}
+	//clusters together cover about half of the area
+	std::normal_distribution<double> spread(0, p.size/(4*std::sqrt(static_cast<double>(clusters))));
+	std::uniform_int_distribution<unsigned> cluster(0, clusters-1);
+
+	std::uniform_int_distribution<unsigned> uniformDemand(1, std::max(1.0, 2*p.meanDemand-1));
+	std::normal_distribution<double> normalDemand(p.meanDemand, p.meanDemand/3);
+	std::exponential_distribution<double> exponentialDemand(1/p.meanDemand);
+	auto demand=[&]() -> std::uint32_t{
+		double d;
+		switch(p.demand){
+			case Demand::UNIFORM: d=uniformDemand(gen); break;
+			case Demand::NORMAL: d=std::round(normalDemand(gen)); break;
+			default: d=std::ceil(exponentialDemand(gen)); break;
+		}
+		//every customer must fit to vehicle
+		return static_cast<std::uint32_t>(std::min<double>(p.capacity, std::max(1.0, d)));
+	};
+
+	if(p.binary){
+		out.number(VRP::BINARY_MAGIC);
+		out.number(VRP::BINARY_VERSION);
+	}
+	out.number(p.customers);
+	out.number(p.capacity);
+	out.number(maxRouteTime);
+	out.number(p.dropTime);
+	out.endLine();
+	out.number(depot);
+	out.number(depot);
+	out.endLine();
+
+	for (unsigned long i = 0; i < p.customers; i++) {
+		double x, y;
+		if(p.layout==Layout::UNIFORM || (p.layout==Layout::MIXED && unit(gen)<0.5)){
+			x=unit(gen)*p.size;
+			y=unit(gen)*p.size;
+		}else{
+			const unsigned c=cluster(gen);
+			x=cx[c]+spread(gen);
+			y=cy[c]+spread(gen);
+		}
+		out.number(clamp(x));
+		out.number(clamp(y));
+		out.number(demand());
+		out.endLine();
+	}
+}
+
+/**
+ * Prints usage of the program.
+ *
+ * @param[in] name
+ * 	Name of the program.
+ */
+static void usage(const char* name){
+	std::cerr << "Usage: " << name << " [options]\n"
+			<< "\t-n N\tnumber of customers, at most 4294967295 (default 1000)\n"
+			<< "\t-s SEED\tseed of random generator (default 1)\n"
+			<< "\t-l LAYOUT\tuniform, clustered or mixed layout of customers (default uniform)\n"
+			<< "\t-k N\tnumber of clusters (default one per 100 customers)\n"
+			<< "\t-w N\tside of square area, at most 30000 (default 1000)\n"
+			<< "\t-q N\tvehicle capacity (default 200)\n"
+			<< "\t-d DIST\tuniform, normal or exponential distribution of demands (default uniform)\n"
+			<< "\t-m X\tmean demand (default 20)\n"
+			<< "\t-t N\tmaximum route time (default 999999, no limit)\n"
+			<< "\t-T X\tmaximum route time X times the trip from depot to the farthest corner and back (X>=1 is feasible)\n"
+			<< "\t-r N\tdrop time (default 0)\n"
+			<< "\t-b\tbinary format\n"
+			<< "\t-o PATH\toutput file (default standard output)" << std::endl;
+}
+
+/**
+ * Entry point of the generator.
+ *
+ * @param[in] argc
+ * 	Number of arguments.
+ * @param[in] argv
+ * 	Arguments.
+ * @return Exits codes.
+ */
+int main(int argc, char* argv[]){
+	Parameters p;
+	const char* path=nullptr;
+
+	for(int a=1; a<argc; a++){
+		std::string arg(argv[a]);
+		if(arg=="-b"){
+			p.binary=true;
+		}else if((arg=="-n" || arg=="-s" || arg=="-l" || arg=="-k" || arg=="-w" || arg=="-q" || arg=="-d"
+				|| arg=="-m" || arg=="-t" || arg=="-T" || arg=="-r" || arg=="-o") && a+1<argc){
+			const std::string value(argv[++a]);
+			if(arg=="-n") p.customers=std::strtoul(value.c_str(), nullptr, 10);
+			else if(arg=="-s") p.seed=std::strtoul(value.c_str(), nullptr, 10);
+			else if(arg=="-k") p.clusters=std::strtoul(value.c_str(), nullptr, 10);
+			else if(arg=="-w") p.size=std::strtoul(value.c_str(), nullptr, 10);
+			else if(arg=="-q") p.capacity=std::strtoul(value.c_str(), nullptr, 10);
+			else if(arg=="-m") p.meanDemand=std::strtod(value.c_str(), nullptr);
+			else if(arg=="-t") p.maxRouteTime=std::strtoul(value.c_str(), nullptr, 10);
+			else if(arg=="-T") p.relativeRouteTime=std::strtod(value.c_str(), nullptr);
+			else if(arg=="-r") p.dropTime=std::strtoul(value.c_str(), nullptr, 10);
+			else if(arg=="-o") path=argv[a];
+			else if(arg=="-l"){
+				if(value=="uniform") p.layout=Layout::UNIFORM;
+				else if(value=="clustered") p.layout=Layout::CLUSTERED;
+				else if(value=="mixed") p.layout=Layout::MIXED;
+				else{
+					usage(argv[0]);
+					return 1;
+				}
+			}else{
+				if(value=="uniform") p.demand=Demand::UNIFORM;
+				else if(value=="normal") p.demand=Demand::NORMAL;
+				else if(value=="exponential") p.demand=Demand::EXPONENTIAL;
+				else{
+					usage(argv[0]);
+					return 1;
+				}
+			}
+		}else{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	//distances are calculated with int (see VRP::distance) and number of customers is 32 bit number
+	if(p.size==0 || p.size>30000 || p.capacity==0 || p.meanDemand<=0
+			|| p.customers>std::numeric_limits<std::uint32_t>::max()){
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::FILE* file=path==nullptr ? stdout : std::fopen(path, "wb");
+	if(file==nullptr){
+		std::cerr << "Can not open "<< path << " for writing: " << std::strerror(errno) << std::endl;
+		return 2;
+	}
+
+	bool good;
+	{
+		Writer out(file, p.binary);
+		generate(p, out);
+		out.flush();
+		good=out.good();
+	}
+	if(path!=nullptr && std::fclose(file)!=0) good=false;
+	if(!good){
+		std::cerr << "Can not write the problem." << std::endl;
+		return 2;
+	}
+	return 0;
+}
+
+/*** End of file: vrpgen.cpp ***/
@@ -0,0 +1,195 @@
+/**
+ * Project: VRPAntColony
+ * @file vrpload.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Load generator for solver daemon. Measures requests per second and latency.
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../src/Protocol.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Shared state of all clients.
+ */
+struct Load{
+	std::string socketPath;
+	SolveRequest request;
+	unsigned long requests=0;	//! total number of requests
+
+	std::atomic<unsigned long> sent;
+	std::atomic<unsigned long> errors;
+	std::mutex latenciesLock;
+	std::vector<double> latencies;	//! milliseconds
+
+	Load() :sent(0), errors(0) {}
+};
+
+/**
+ * Connects to the daemon.
+ *
+ * @param[in] path
+ * 	Path of Unix domain socket.
+ * @return Socket or -1 on error.
+ */
+static int connectTo(const std::string& path){
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family=AF_UNIX;
+	if(path.size()>=sizeof(addr.sun_path)) return -1;
+	std::strcpy(addr.sun_path, path.c_str());
+
+	int s=socket(AF_UNIX, SOCK_STREAM, 0);
+	if(s<0) return -1;
+	if(connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))<0){
+		close(s);
+		return -1;
+	}
+	return s;
+}
+
+/**
+ * One client that sends requests one by one over its own connection.
+ *
+ * @param[in] load
+ * 	Shared state.
+ */
+static void client(Load& load){
+	int s=connectTo(load.socketPath);
+	if(s<0){
+		std::cerr << "Can not connect to " << load.socketPath << ": " << std::strerror(errno) << std::endl;
+		return;
+	}
+	FdReader reader(s);
+	std::vector<double> latencies;
+	std::string header, body;
+
+	for(unsigned long sent=load.sent++; sent<load.requests; sent=load.sent++){
+		//other clients are sending too, so the id is taken from our own increment
+		SolveRequest request=load.request;
+		request.id=std::to_string(sent+1);
+
+		Clock::time_point start=Clock::now();
+		if(!writeAll(s, formatRequest(request)) || !reader.readLine(header) || !reader.readLine(body)){
+			std::cerr << "Connection closed by daemon." << std::endl;
+			load.errors++;
+			break;
+		}
+		latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now()-start).count());
+		if(header.compare(0, 6, "RESULT")!=0){
+			std::cerr << header << ": " << body << std::endl;
+			load.errors++;
+		}
+	}
+	close(s);
+
+	std::lock_guard<std::mutex> guard(load.latenciesLock);
+	load.latencies.insert(load.latencies.end(), latencies.begin(), latencies.end());
+}
+
+/**
+ * Prints usage of the program.
+ *
+ * @param[in] name
+ * 	Name of the program.
+ */
+static void usage(const char* name){
+	std::cerr << "Usage: " << name << " [-c CLIENTS] [-n REQUESTS] [-i ITERATIONS] [-s SEED] SOCKET_PATH PATH_TO_PROBLEM\n"
+			<< "\t-c N\tnumber of concurrent clients (default 4)\n"
+			<< "\t-n N\ttotal number of requests (default 100)\n"
+			<< "\t-i N\titerations of every solving (default 10)\n"
+			<< "\t-s N\tseed of every solving (default 0, random)" << std::endl;
+}
+
+/**
+ * Percentile of sorted values.
+ */
+static double percentile(const std::vector<double>& sorted, const double p){
+	if(sorted.empty()) return 0;
+	std::size_t i=static_cast<std::size_t>(p*(sorted.size()-1)+0.5);
+	return sorted[std::min(i, sorted.size()-1)];
+}
+
+/**
+ * Entry point of the load generator.
+ *
+ * @param[in] argc
+ * 	Number of arguments.
+ * @param[in] argv
+ * 	Arguments.
+ * @return Exits codes.
+ */
+int main(int argc, char* argv[]){
+	Load load;
+	load.requests=100;
+	load.request.iterations=10;
+	unsigned clients=4;
+	std::vector<std::string> positional;
+
+	for(int a=1; a<argc; a++){
+		std::string arg(argv[a]);
+		if((arg=="-c" || arg=="-n" || arg=="-i" || arg=="-s") && a+1<argc){
+			unsigned long value=std::strtoul(argv[++a], nullptr, 10);
+			if(arg=="-c") clients=value;
+			else if(arg=="-n") load.requests=value;
+			else if(arg=="-i") load.request.iterations=value;
+			else load.request.seed=value;
+		}else if(arg.empty() || arg[0]!='-'){
+			positional.push_back(arg);
+		}else{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if(positional.size()!=2 || clients==0){
+		usage(argv[0]);
+		return 1;
+	}
+	load.socketPath=positional[0];
+
+	std::ifstream file(positional[1]);
+	if(!file){
+		std::cerr << "Can not open "<< positional[1] << " for reading."<< std::endl;
+		return 2;
+	}
+	std::stringstream problem;
+	problem << file.rdbuf();
+	load.request.problem=problem.str();
+
+	Clock::time_point start=Clock::now();
+	std::vector<std::thread> threads;
+	for(unsigned c=0; c<clients; c++) threads.push_back(std::thread(client, std::ref(load)));
+	for(std::thread& t : threads) t.join();
+	double seconds=std::chrono::duration<double>(Clock::now()-start).count();
+
+	std::vector<double>& l=load.latencies;
+	std::sort(l.begin(), l.end());
+	double sum=0;
+	for(double v : l) sum+=v;
+
+	std::cout << "requests: " << l.size() << " errors: " << load.errors << " clients: " << clients << "\n"
+			<< "time: " << seconds << " s\n"
+			<< "requests per second: " << (seconds>0 ? l.size()/seconds : 0) << "\n"
+			<< "latency ms: mean " << (l.empty() ? 0 : sum/l.size())
+			<< " p50 " << percentile(l, 0.5) << " p99 " << percentile(l, 0.99)
+			<< " max " << (l.empty() ? 0 : l.back()) << std::endl;
+	return load.errors>0 ? 3 : 0;
+}
+
+/*** End of file: vrpload.cpp ***/
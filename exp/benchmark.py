@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""
+Benchmark runner. Runs solver repeatedly over problem files and records:
+    anytime curve (best cost vs. elapsed time) of every run,
+    gap to best known result, time to target gap and variance of results.
+
+Best known results are read from file bestknown.txt (name cost) in directory of the problem.
+
+Example:
+    exp/benchmark.py -r 5 -t 10 --csv exp/bench --json exp/bench.json solve
+"""
+
+import argparse
+import csv
+import json
+import math
+import os
+import re
+import shlex
+import statistics
+import subprocess
+import sys
+import time
+
+PROGRESS = re.compile(r"^(\d+)\. ITER best so far: (\S+) time: (\S+)$")
+
+
+def load_best_known(directory):
+    """Reads best known results (name -> cost) from bestknown.txt in directory."""
+    best = {}
+    path = os.path.join(directory, "bestknown.txt")
+    if os.path.exists(path):
+        with open(path) as f:
+            for line in f:
+                parts = line.split()
+                if len(parts) == 2:
+                    best[parts[0]] = float(parts[1])
+    return best
+
+
+def find_problems(directories, pattern):
+    """Finds problem files in directories. Returns list of (name, path, best known cost or None)."""
+    problems = []
+    for d in directories:
+        best = load_best_known(d)
+        names = [f for f in os.listdir(d) if re.fullmatch(pattern, f)]
+        # natural order: vrpnc2 before vrpnc10
+        names.sort(key=lambda n: [int(t) if t.isdigit() else t for t in re.split(r"(\d+)", n)])
+        for f in names:
+            name = os.path.splitext(f)[0]
+            problems.append((name, os.path.join(d, f), best.get(name)))
+    return problems
+
+
+def run(binary, path, seed, args):
+    """Runs solver once. Returns (curve [(time, cost)], final cost, iterations, wall time)."""
+    cmd = [binary, "-s", str(seed), "-p", "0"] + args + [path]
+    start = time.monotonic()
+    out = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                         universal_newlines=True, check=True).stdout
+    wall = time.monotonic() - start
+
+    curve = []
+    iterations = 0
+    for line in out.splitlines():
+        m = PROGRESS.match(line)
+        if m:
+            iterations = int(m.group(1)) + 1
+            cost, t = float(m.group(2)), float(m.group(3))
+            if not curve or cost < curve[-1][1]:
+                curve.append((t, cost))
+    final = float(out.strip().splitlines()[-1])
+    return curve, final, iterations, wall
+
+
+def gap(cost, best):
+    return None if best is None else 100.0 * (cost - best) / best
+
+
+def time_to_target(curve, best, target):
+    """First time when gap to best known result is at most target percents."""
+    if best is None:
+        return None
+    for t, cost in curve:
+        if gap(cost, best) <= target:
+            return t
+    return None
+
+
+def cost_at(curve, t):
+    """Best cost found until time t (None before first solution)."""
+    res = None
+    for ct, cost in curve:
+        if ct > t:
+            break
+        res = cost
+    return res
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark of VRP solver.")
+    parser.add_argument("directories", nargs="*", default=["solve"],
+                        help="directories with problems (default solve)")
+    parser.add_argument("-b", "--binary", default="./vrp", help="solver binary (default ./vrp)")
+    parser.add_argument("-r", "--repetitions", type=int, default=10, help="runs of every problem (default 10)")
+    parser.add_argument("-s", "--seed", type=int, default=1, help="seed of first run, next runs use seed+1, ... (default 1)")
+    parser.add_argument("-t", "--time-limit", type=float, help="time limit of one run in seconds")
+    parser.add_argument("-i", "--iterations", type=int, help="iterations of one run (default 2n)")
+    parser.add_argument("-p", "--pattern", default=r"vrpnc\d+\.txt", help="regex of problem file names")
+    parser.add_argument("-T", "--targets", default="1,2,5", help="gaps in percents for time to target (default 1,2,5)")
+    parser.add_argument("--grid", type=int, default=20, help="number of time points of mean anytime curve (default 20)")
+    parser.add_argument("--csv", help="prefix of CSV files (PREFIX_runs.csv, PREFIX_curves.csv, PREFIX_summary.csv)")
+    parser.add_argument("--json", help="JSON file with all results")
+    parser.add_argument("-a", "--args", default="", help="other arguments of solver, e.g. -a=-g")
+    a = parser.parse_args()
+
+    labels = [x for x in a.targets.split(",") if x]
+    targets = [(label, float(label)) for label in labels]
+    solver_args = shlex.split(a.args)
+    if a.time_limit is not None:
+        solver_args += ["-t", str(a.time_limit)]
+    if a.iterations is not None:
+        solver_args += ["-i", str(a.iterations)]
+
+    runs = []
+    summary = []
+    for name, path, best in find_problems(a.directories, a.pattern):
+        problem_runs = []
+        for r in range(a.repetitions):
+            seed = a.seed + r
+            curve, final, iterations, wall = run(a.binary, path, seed, solver_args)
+            res = {
+                "problem": name, "repetition": r, "seed": seed, "cost": final, "best_known": best,
+                "gap": gap(final, best), "iterations": iterations, "time": wall,
+                "time_to_target": {label: time_to_target(curve, best, tg) for label, tg in targets},
+                "curve": curve,
+            }
+            problem_runs.append(res)
+            print("%s\trep %d\tcost %.2f\tgap %s\ttime %.2f s" % (
+                name, r, final, "-" if best is None else "%.2f %%" % res["gap"], wall), file=sys.stderr)
+
+        costs = [x["cost"] for x in problem_runs]
+        times = [x["time"] for x in problem_runs]
+        horizon = max(times)
+        grid = [horizon * (k + 1) / a.grid for k in range(a.grid)]
+        mean_curve = []
+        for t in grid:
+            at = [cost_at(x["curve"], t) for x in problem_runs]
+            at = [c for c in at if c is not None]
+            if at:
+                mean_curve.append((t, statistics.mean(at)))
+
+        s = {
+            "problem": name, "best_known": best, "runs": len(costs),
+            "best": min(costs), "mean": statistics.mean(costs),
+            "stdev": statistics.stdev(costs) if len(costs) > 1 else 0.0,
+            "best_gap": gap(min(costs), best), "mean_gap": gap(statistics.mean(costs), best),
+            "mean_time": statistics.mean(times),
+            "time_to_target": {},
+            "mean_curve": mean_curve,
+        }
+        for label in labels:
+            reached = [x["time_to_target"][label] for x in problem_runs if x["time_to_target"][label] is not None]
+            s["time_to_target"][label] = {
+                "success": len(reached) / len(problem_runs),
+                "mean": statistics.mean(reached) if reached else None,
+            }
+        summary.append(s)
+        runs.extend(problem_runs)
+
+    fmt = lambda v: "" if v is None else ("%.6g" % v if isinstance(v, float) else str(v))
+
+    # summary table
+    header = ["problem", "best_known", "runs", "best", "mean", "stdev", "best_gap", "mean_gap", "mean_time"]
+    header += ["ttt%s_success" % label for label in labels]
+    header += ["ttt%s_mean" % label for label in labels]
+    rows = []
+    for s in summary:
+        row = [s[h] for h in header[:9]]
+        row += [s["time_to_target"][label]["success"] for label in labels]
+        row += [s["time_to_target"][label]["mean"] for label in labels]
+        rows.append([fmt(v) for v in row])
+    print("\t".join(header))
+    for row in rows:
+        print("\t".join(row))
+
+    if a.csv:
+        with open(a.csv + "_summary.csv", "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(header)
+            w.writerows(rows)
+        with open(a.csv + "_runs.csv", "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(["problem", "repetition", "seed", "cost", "best_known", "gap", "iterations", "time"]
+                       + ["ttt%s" % label for label in labels])
+            for x in runs:
+                w.writerow([fmt(v) for v in [x["problem"], x["repetition"], x["seed"], x["cost"], x["best_known"],
+                                             x["gap"], x["iterations"], x["time"]]]
+                           + [fmt(x["time_to_target"][label]) for label in labels])
+        with open(a.csv + "_curves.csv", "w", newline="") as f:
+            w = csv.writer(f)
+            w.writerow(["problem", "repetition", "time", "cost"])
+            for x in runs:
+                for t, cost in x["curve"]:
+                    w.writerow([x["problem"], x["repetition"], fmt(t), fmt(cost)])
+
+    if a.json:
+        with open(a.json, "w") as f:
+            json.dump({"binary": a.binary, "solver_args": solver_args, "summary": summary, "runs": runs}, f, indent=1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Checks solution printed by the solver (last two lines of its output are read from standard input):
+    every customer is visited exactly once, capacity and maximum route time are not exceeded
+    and printed cost is the cost of printed routes.
+
+With --split it also checks that routes are the optimal split of their concatenation
+(giant tour), so it must be used with build without local search (make vrpW2O and -g).
+With --exact N it checks that routes with at most N customers have optimal order (solver option -e).
+
+Example:
+    ./vrp -s 1 -q solve/vrpnc1.txt | exp/check.py solve/vrpnc1.txt
+"""
+
+import argparse
+import math
+import sys
+
+EPS = 1e-6
+
+
+def load_problem(path):
+    """Reads problem in text format. Returns capacity, max route time, drop time and customers (x, y, demand) with depot at index 0."""
+    with open(path) as f:
+        lines = [line.split() for line in f if line.strip()]
+    n, capacity, max_time, drop = (int(v) for v in lines[0][:4])
+    points = [(int(lines[1][0]), int(lines[1][1]), 0)]
+    for parts in lines[2:2 + n]:
+        points.append((int(parts[0]), int(parts[1]), int(parts[2])))
+    if len(points) != n + 1:
+        raise ValueError("problem has less customers than its header says")
+    return capacity, max_time, drop, points
+
+
+def read_solution(text):
+    """Parses routes (lists of customers without depot) and cost from output of the solver."""
+    lines = [line for line in text.strip().split("\n") if line.strip()]
+    if len(lines) < 2:
+        raise ValueError("output has no solution")
+    ids = [int(v) for v in lines[-2].split()]
+    if not ids or ids[0] != 0 or ids[-1] != 0:
+        raise ValueError("solution must start and end in depot")
+    routes = [[]]
+    for c in ids[1:]:
+        if c == 0:
+            routes.append([])
+        else:
+            routes[-1].append(c)
+    return [r for r in routes if r], float(lines[-1])
+
+
+def check(problem, routes, cost, split, exact):
+    """Returns list of errors of the solution."""
+    capacity, max_time, drop, points = problem
+
+    def dist(a, b):
+        return math.sqrt((points[a][0] - points[b][0]) ** 2 + (points[a][1] - points[b][1]) ** 2)
+
+    def route_cost(r):
+        return dist(0, r[0]) + sum(dist(a, b) for a, b in zip(r, r[1:])) + dist(r[-1], 0)
+
+    errors = []
+    seen = set()
+    total = 0
+    for i, r in enumerate(routes):
+        for c in r:
+            if c >= len(points) or c in seen:
+                errors.append("customer %d is not valid or visited twice" % c)
+            seen.add(c)
+        load = sum(points[c][2] for c in r if c < len(points))
+        if load > capacity:
+            errors.append("route %d exceeds capacity: %d > %d" % (i, load, capacity))
+        c = route_cost(r)
+        if c + drop * len(r) > max_time + EPS:
+            errors.append("route %d exceeds maximum route time: %f > %d" % (i, c + drop * len(r), max_time))
+        total += c
+    if len(seen) != len(points) - 1:
+        errors.append("%d of %d customers are visited" % (len(seen), len(points) - 1))
+    #cost is printed with 6 significant digits
+    if abs(total - cost) > 1e-5 * max(1, total):
+        errors.append("printed cost %f is not cost of routes %f" % (cost, total))
+
+    for i, r in enumerate(routes):
+        if len(r) <= exact and not errors:
+            #Held-Karp over customers of the route
+            best = {}
+            for j, c in enumerate(r):
+                best[(1 << j, j)] = dist(0, c)
+            for mask in range(1, 1 << len(r)):
+                for j in range(len(r)):
+                    if (mask, j) not in best:
+                        continue
+                    for k in range(len(r)):
+                        if mask & (1 << k):
+                            continue
+                        key = (mask | (1 << k), k)
+                        value = best[(mask, j)] + dist(r[j], r[k])
+                        if value < best.get(key, math.inf):
+                            best[key] = value
+            full = (1 << len(r)) - 1
+            optimal = min(best[(full, j)] + dist(r[j], 0) for j in range(len(r)))
+            if route_cost(r) > optimal + 1e-6:
+                errors.append("route %d costs %f, but its optimal order costs %f" % (i, route_cost(r), optimal))
+
+    if split and not errors:
+        #the best split of the giant tour (Bellman over all feasible routes)
+        tour = [c for r in routes for c in r]
+        best = [0] + [math.inf] * len(tour)
+        for i in range(len(tour)):
+            load = 0
+            length = 0
+            for j in range(i, len(tour)):
+                load += points[tour[j]][2]
+                if j > i:
+                    length += dist(tour[j - 1], tour[j])
+                route = dist(0, tour[i]) + length + dist(tour[j], 0)
+                if load > capacity or route + drop * (j - i + 1) > max_time + EPS:
+                    break
+                best[j + 1] = min(best[j + 1], best[i] + route)
+        if total > best[-1] + 1e-5 * max(1, total):
+            errors.append("routes cost %f, but the best split of their tour costs %f" % (total, best[-1]))
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Checks solution of the solver read from standard input.")
+    parser.add_argument("problem", help="problem in text format")
+    parser.add_argument("--split", action="store_true", help="routes must be the best split of their tour")
+    parser.add_argument("--exact", type=int, default=0, help="routes with at most N customers must have optimal order")
+    args = parser.parse_args()
+
+    try:
+        routes, cost = read_solution(sys.stdin.read())
+        errors = check(load_problem(args.problem), routes, cost, args.split, args.exact)
+    except ValueError as e:
+        errors = [str(e)]
+    if errors:
+        for e in errors:
+            print("%s: %s" % (args.problem, e), file=sys.stderr)
+        return 1
+    print(cost)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
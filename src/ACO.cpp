@@ -10,8 +10,32 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cmath>
+#include <limits>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include "Kernels.h"
+
+ACO::ACO() :pheromoneScale(1), localSearchNanos(0), depositors(0), renormalizing(false), choiceData(nullptr), choiceSlot(0) {
+	choiceReaders[0]=0;
+	choiceReaders[1]=0;
+	#ifdef GIANT_TOUR
+	giantTour=true;
+	#endif
+}
 
-ACO::ACO(VRP& v) :vrp(v) {
+ACO::ACO(VRP& v) :ACO() {
+	load(v);
+}
+
+void ACO::load(const VRP& v){
+	vrp=v;
+	//buffers of arcs keep their capacity, so loading of problem that is not bigger
+	//than the previous one does not allocate them again
+	vertices.clear();
+	ants.clear();
 
 	//create vertices
 	//depot is first
@@ -25,173 +49,738 @@ ACO::ACO(VRP& v) :vrp(v) {
 		v.c=&c;
 		vertices.push_back(v);
 	}
+	for(Vertex& v : vertices) v.depotDistance=v.distToVertex(vertices[0]);
 
 	//according to paper n/4
 	numOfCandidates=vrp.getCustomers().size()/4;
-	arcCreate();
-
-	//create ants
-	//according to paper we are creating one ant at each customer
-	for (unsigned i = 1; i < vertices.size(); i++) { //zero is depot
-		ants.push_back(Ant(&vertices[i], this));
-	}
+	//arcs and ants are created with first solving
+	arcsCreated=false;
+	routeCache.clear();
+	gridCreate();
 }
 
 void ACO::arcCreate(){
 	//clear old arcs
-	arcs.clear();
-	arcs.reserve(vertices.size()*(1+vertices.size()-2)/2);	//sum of arithmetic series
+	const unsigned n=vertices.size();
+	routeCache.clear();	//cached routes could be optimized with other parameters
+
+	//distances to depot in contiguous array for visibility calculation
+	std::vector<double> d0(n);
+	for (unsigned i = 0; i < n; i++) d0[i] = vertices[i].depotDistance;
+
+	if(population>0){
+		//population based colony has arc data of candidates only (they are created with candidates)
+		//so the memory of arrays for all arcs is released
+		std::vector<double>().swap(pheromone);
+		distance.clear();
+		visibility.clear();
+		choiceInfo.clear();
+		visibilityShift=0;
+		#ifndef VIS_DISTANCE
+		visibilityShiftCreate(d0);
+		#endif
+	}else{
+		const std::size_t m=n<2 ? 0 : static_cast<std::size_t>(n)*(n-1)/2;	//sum of arithmetic series
+		if(m>MAX_ARCS){
+			throw std::runtime_error("Too many customers for pheromone of all arcs (at most 92681)."
+					" Use population based colony or decomposition.");
+		}
+		distance.resize(m);
+		visibility.resize(m);
+		pheromone.assign(m, 0);
+		choiceInfo.assign(m, 0);
+
+		//arcs of vertex i with greater vertices are stored in one row
+		std::size_t e=0;
+		for (unsigned i = 0; i + 1 < n; i++) {
+			for (unsigned j = i + 1; j < n; j++) {
+				distance[e++]=vertices[i].distToVertex(vertices[j]);
+			}
+		}
+
+		//lets calc visibility
+		#ifndef VIS_DISTANCE
+		double visibilityMin=std::numeric_limits<double>::infinity();
+		for (unsigned i = 0; i + 1 < n; i++) {
+			const unsigned row=edgeIndex(i, i+1);
+			visibilityMin=std::min(visibilityMin, Kernels::savings(&d0[i+1], &distance[row], d0[i], g, f,
+					&visibility[row], n-i-1));
+		}
+
+		//shift visibility
+		if(visibilityMin<=0){
+			Kernels::shiftPow(visibility.data(), m, (-visibilityMin)+1, beta);
+		}
+		#endif
+
+		#ifdef VIS_DISTANCE
+		for (std::size_t e = 0; e < m; e++) {
+			if(distance[e]==0){
+				visibility[e]=1;
+			}else{
+				visibility[e]=1/distance[e];
+			}
+		}
+		#endif
+	}
+
+	//arrays of arcs are ready, candidates are selected with them
+	arcsCreated=true;
+
+	//create list of vertices to visit for each vertex
+	//all lists are stored in one array and vertex i has candidates [candidateOffsets[i], candidateOffsets[i+1])
+	candidateOffsets.assign(1, 0);
+	candidates.clear();
+	std::vector<Candidate> all;
+	std::vector<double> rowDistance(n);
+	all.reserve(n);
+	#ifndef NO_CANDIDATES
+	//population based colony has fixed number of candidates, so its memory is linear
+	const unsigned listSize=population>0 ? std::min(numOfCandidates, PACO_CANDIDATES) : numOfCandidates;
+	std::vector<std::uint32_t> near;
+	#endif
+	for (unsigned i = 0; i < n; i++) {
+		all.clear();
+
+		#ifndef NO_CANDIDATES
+		if (population>0 && vertices[i].c->type != EnityType::DEPOT && listSize + 1 < n - 1) {
+			//the nearest customers are found with grid, so arcs of all vertices are not calculated
+			nearestCustomers(i, listSize, near);
+			for(std::uint32_t j : near){
+				rowDistance[j]=arcDistance(i, j);
+				all.push_back(Candidate{j, 0});
+			}
+			//depot is always candidate
+			rowDistance[0]=arcDistance(i, 0);
+			all.push_back(Candidate{0, 0});
+		}
+		#endif
+
+		if(all.empty()){
+			for (unsigned j = 0; j < n; j++) {
+				if (j != i){
+					rowDistance[j]=arcDistance(i, j);
+					all.push_back(Candidate{j, population>0 ? 0 : edgeIndex(i, j)});
+				}
+			}
+		}
+
+		#ifndef NO_CANDIDATES
+		//depot can go to all customers
+		//if there is not more than listSize+1 vertices than depot must be in and also there is no need for filtering
+		if (vertices[i].c->type != EnityType::DEPOT && listSize + 1 < all.size()) {
+			//sort the arcs according to distances and filter only the best ones as candidates
+			//+1 because of reserve for depot
+			std::partial_sort(all.begin(), all.begin() + listSize + 1, all.end(),
+					[&rowDistance](const Candidate& a, const Candidate& b) -> bool
+					{	return rowDistance[a.vertex] < rowDistance[b.vertex];});
+			all.resize(listSize + 1);
+
+			bool containsDepot = false;
+			for (const Candidate& c : all) {
+				if (c.vertex == 0) {
+					containsDepot = true;
+					break;
+				}
+			}
+			if (!containsDepot) {
+				//depot is not in candidates
+				all.back() = Candidate{0, population>0 ? 0 : edgeIndex(i, 0)};
+			}
+		}
+		#endif
+
+		if(population>0){
+			//candidates are sorted by vertices, so the arc of archived solution is found with binary search
+			std::sort(all.begin(), all.end(), [](const Candidate& a, const Candidate& b) -> bool{
+				return a.vertex<b.vertex;
+			});
+			if(distance.size()+all.size()>MAX_ARCS) throw std::runtime_error("Too many candidates for their indices.");
+			for (Candidate& c : all) {
+				c.arc=distance.size();
+				distance.push_back(rowDistance[c.vertex]);
+				visibility.push_back(arcVisibility(i, c.vertex));
+			}
+		}
+
+		candidates.insert(candidates.end(), all.begin(), all.end());
+		candidateOffsets.push_back(candidates.size());
+	}
 
-	for(Vertex& v: vertices)v.candidates.clear();
+	if(population>0){
+		choiceInfo.assign(visibility.size(), 0);
+		distance.shrink_to_fit();
+		visibility.shrink_to_fit();
+		choiceInfo.shrink_to_fit();
+	}
+}
 
-	#ifndef VIS_DISTANCE
+#ifndef VIS_DISTANCE
+void ACO::visibilityShiftCreate(const std::vector<double>& d0){
+	//shift needs minimum of all savings, so they are calculated row by row and thrown away
+	const unsigned n=vertices.size();
+	std::vector<double> row(n), savings(n);
 	double visibilityMin=std::numeric_limits<double>::infinity();
+	for (unsigned i = 0; i + 1 < n; i++) {
+		for (unsigned j = i + 1; j < n; j++) row[j-i-1]=vertices[i].distToVertex(vertices[j]);
+		visibilityMin=std::min(visibilityMin, Kernels::savings(&d0[i+1], row.data(), d0[i], g, f,
+				savings.data(), n-i-1));
+	}
+	if(visibilityMin<=0) visibilityShift=(-visibilityMin)+1;
+}
+#endif
+
+double ACO::arcVisibility(const unsigned i, const unsigned j) const{
+	const double d=vertices[i].distToVertex(vertices[j]);
+	#ifdef VIS_DISTANCE
+	return d==0 ? 1 : 1/d;
+	#else
+	//the same calculation as for row of all arcs in arcCreate
+	double v;
+	Kernels::savings(&vertices[std::max(i, j)].depotDistance, &d, vertices[std::min(i, j)].depotDistance, g, f, &v, 1);
+	if(visibilityShift>0) Kernels::shiftPow(&v, 1, visibilityShift, beta);
+	return v;
 	#endif
+}
 
-	//select max
-	for (int i = 0; i < static_cast<int>(vertices.size()) - 1; i++) {
-		for (int j = i + 1; j < static_cast<int>(vertices.size()); j++) {
+const Candidate* ACO::findCandidate(const unsigned i, const unsigned j) const{
+	const Candidate* c=std::lower_bound(candidatesBegin(i), candidatesEnd(i), j,
+			[](const Candidate& a, const unsigned v) -> bool{
+				return a.vertex<v;
+			});
+	return c!=candidatesEnd(i) && c->vertex==j ? c : nullptr;
+}
 
-			Arc a;
+double ACO::arcChoice(const unsigned i, const unsigned j, const double* choice) const{
+	double p;
+	if(population==0){
+		//other threads can change it in asynchronous colony
+		__atomic_load(&choice[edgeIndex(i, j)], &p, __ATOMIC_RELAXED);
+		return p;
+	}
 
-			a.distance=vertices[i].distToVertex(vertices[j]);
+	const Candidate* c=findCandidate(i, j);
+	if(c!=nullptr) return choiceInfo[c->arc];
 
-			a.v.insert(&vertices[i]);
-			a.v.insert(&vertices[j]);
+	const auto count=edgeCounts.find(edgeKey(i, j));
+	const double tau=populationPheromone(count==edgeCounts.end() ? 0 : count->second);
+	const double v=arcVisibility(i, j);
+	Kernels::choiceInfo(&tau, &v, alfa, &p, 1);
+	return p;
+}
 
-			//lets calc visibility
+void ACO::countSolution(const std::vector<const Vertex*>& solution, const bool add){
+	for (unsigned vi = 0; vi + 1 < solution.size(); vi++) {
+		//vertex index is the same as id of its entity
+		const unsigned i=solution[vi]->c->id;
+		const unsigned j=solution[vi+1]->c->id;
+		const std::uint64_t key=edgeKey(i, j);
+
+		std::uint32_t count;
+		if(add){
+			count=++edgeCounts[key];
+		}else{
+			const auto it=edgeCounts.find(key);
+			count=--it->second;
+			if(count==0) edgeCounts.erase(it);
+		}
 
+		touchVertex(i);
+		touchVertex(j);
 
+		//arc is stored in lists of both its vertices, if it is candidate there
+		const double tau=populationPheromone(count);
+		for(const Candidate* c : {findCandidate(i, j), findCandidate(j, i)}){
+			if(c!=nullptr) Kernels::choiceInfo(&tau, &visibility[c->arc], alfa, &choiceInfo[c->arc], 1);
+		}
+	}
+}
 
-			#ifndef VIS_DISTANCE
-			a.visibility=vertices[i].distToVertex(vertices[0])+vertices[0].distToVertex(vertices[j])
-				-g*a.distance
-				+f*std::abs(vertices[i].distToVertex(vertices[0])-vertices[0].distToVertex(vertices[j]));
+void ACO::updateArchive(const std::vector<const Vertex*>& iterationBest, const bool newBest){
+	archive.push_back(iterationBest);
+	countSolution(archive.back(), true);
+	if(archive.size()>population){
+		countSolution(archive.front(), false);
+		archive.pop_front();
+	}
 
-			if(visibilityMin>a.visibility) visibilityMin=a.visibility;
-			#endif
+	if(newBest){
+		if(!archivedBest.empty()) countSolution(archivedBest, false);
+		archivedBest=bestSoFar.second;
+		countSolution(archivedBest, true);
+	}
+}
 
-			#ifdef VIS_DISTANCE
-			if(a.distance==0){
-				a.visibility=1;
-			}else{
-				a.visibility=1/a.distance;
-			}
-			#endif
+void ACO::gridCreate(){
+	const unsigned n=vertices.size();
+	grid=Grid();
+	if(n<2) return;
+
+	double maxX=vertices[1].c->p.x, maxY=vertices[1].c->p.y;
+	grid.x0=maxX;
+	grid.y0=maxY;
+	for (unsigned i = 1; i < n; i++) {
+		grid.x0=std::min<double>(grid.x0, vertices[i].c->p.x);
+		grid.y0=std::min<double>(grid.y0, vertices[i].c->p.y);
+		maxX=std::max<double>(maxX, vertices[i].c->p.x);
+		maxY=std::max<double>(maxY, vertices[i].c->p.y);
+	}
 
+	//about two customers in one cell
+	const double side=std::ceil(std::sqrt((n-1)/2.0));
+	grid.cellSize=std::max(std::max(maxX-grid.x0, maxY-grid.y0)/side, 1.0);
+	grid.width=static_cast<unsigned>((maxX-grid.x0)/grid.cellSize)+1;
+	grid.height=static_cast<unsigned>((maxY-grid.y0)/grid.cellSize)+1;
+
+	//customers are sorted by cells with counting sort
+	grid.cellOf.resize(n);
+	grid.cellOffsets.assign(grid.width*grid.height+1, 0);
+	for (unsigned i = 0; i < n; i++) {
+		grid.cellOf[i]=grid.row(vertices[i].c->p.y)*grid.width+grid.column(vertices[i].c->p.x);
+		if(i>0) grid.cellOffsets[grid.cellOf[i]+1]++;
+	}
+	for (unsigned c = 0; c+1 < grid.cellOffsets.size(); c++) grid.cellOffsets[c+1]+=grid.cellOffsets[c];
 
+	grid.customers.resize(n-1);
+	std::vector<std::uint32_t> filled(grid.cellOffsets.begin(), grid.cellOffsets.end()-1);
+	for (unsigned i = 1; i < n; i++) grid.customers[filled[grid.cellOf[i]]++]=i;
+}
 
+void CandidateLists::init(const ACO& aco){
+	vertices=&aco.getVertices();
+	grid=&aco.getGrid();
+	const unsigned n=vertices->size();
+	fallbacks=0;
+	lateReturns=0;
+
+	entries.assign(aco.candidatesBegin(0), aco.candidatesEnd(n-1));
+	offsets.resize(n+1);
+	for (unsigned v = 0; v <= n; v++) {
+		offsets[v]=v<n ? aco.candidatesBegin(v)-aco.candidatesBegin(0) : entries.size();
+	}
+	live.resize(n);
+	origin.resize(entries.size());
+	where.resize(entries.size());
+	owner.resize(entries.size());
+	for (unsigned v = 0; v < n; v++) {
+		for (std::uint32_t e = offsets[v]; e < offsets[v+1]; e++) {
+			origin[e]=e;
+			where[e]=e;
+			owner[e]=v;
+		}
+	}
 
-			//create the arc
-			arcs.push_back(a);
+	//entries of every customer (counting sort by candidate vertex)
+	occurrenceOffsets.assign(n+1, 0);
+	for(const Candidate& c : entries) occurrenceOffsets[c.vertex+1]++;
+	for (unsigned v = 0; v < n; v++) occurrenceOffsets[v+1]+=occurrenceOffsets[v];
+	occurrences.resize(entries.size());
+	std::vector<std::uint32_t> filled(occurrenceOffsets.begin(), occurrenceOffsets.end()-1);
+	for (std::uint32_t e = 0; e < entries.size(); e++) occurrences[filled[entries[e].vertex]++]=e;
+
+	cellCustomers=grid->customers;
+	cellWhere.assign(n, 0);
+	for (std::uint32_t i = 0; i < cellCustomers.size(); i++) cellWhere[cellCustomers[i]]=i;
+	const unsigned cells=grid->cellOffsets.empty() ? 0 : grid->cellOffsets.size()-1;
+	cellLive.resize(cells);
+	initialCellMin.assign(cells, std::numeric_limits<unsigned>::max());
+	for (unsigned c = 0; c < cells; c++) {
+		for (std::uint32_t i = grid->cellOffsets[c]; i < grid->cellOffsets[c+1]; i++) {
+			initialCellMin[c]=std::min(initialCellMin[c], (*vertices)[cellCustomers[i]].c->quantity);
+		}
+	}
+	reset();
+}
 
-			//set arc to vertices
-			vertices[i].candidates.push_back(&arcs.back());
-			vertices[j].candidates.push_back(&arcs.back());
+void CandidateLists::reset(){
+	//removed entries are only behind the ends, so lists just get their original lengths
+	for (unsigned v = 0; v < live.size(); v++) live[v]=offsets[v+1]-offsets[v];
+	visited.assign(live.size(), 0);
+	visitedCount=0;
+	for (unsigned c = 0; c < cellLive.size(); c++) cellLive[c]=grid->cellOffsets[c+1]-grid->cellOffsets[c];
+	cellMin=initialCellMin;
+}
 
+void CandidateLists::swapEntries(const std::uint32_t a, const std::uint32_t b){
+	std::swap(entries[a], entries[b]);
+	std::swap(origin[a], origin[b]);
+	where[origin[a]]=a;
+	where[origin[b]]=b;
+}
 
+void CandidateLists::visit(const unsigned v){
+	visited[v]=1;
+	visitedCount++;
+
+	//swap the customer behind the end of every list that contains it
+	for (std::uint32_t o = occurrenceOffsets[v]; o < occurrenceOffsets[v+1]; o++) {
+		const std::uint32_t e=occurrences[o];
+		const std::uint32_t u=owner[e];
+		if(where[e]<offsets[u]+live[u]){
+			swapEntries(where[e], offsets[u]+live[u]-1);
+			live[u]--;
 		}
 	}
 
+	//and from its cell
+	const unsigned c=grid->cellOf[v];
+	const std::uint32_t last=grid->cellOffsets[c]+cellLive[c]-1;
+	const std::uint32_t moved=cellCustomers[last];
+	std::swap(cellCustomers[cellWhere[v]], cellCustomers[last]);
+	cellWhere[moved]=cellWhere[v];
+	cellWhere[v]=last;
+	cellLive[c]--;
+	if((*vertices)[v].c->quantity==cellMin[c]){
+		cellMin[c]=std::numeric_limits<unsigned>::max();
+		for(const std::uint32_t* i=cellBegin(c); i!=cellEnd(c); ++i){
+			cellMin[c]=std::min(cellMin[c], (*vertices)[*i].c->quantity);
+		}
+	}
+}
 
-	#ifndef VIS_DISTANCE
-	//shift visibility
-	if(visibilityMin<=0){
-		visibilityMin=(-visibilityMin)+1;
-		for(Arc& a : arcs){
-			a.visibility=std::pow(visibilityMin+a.visibility, beta);
+void ACO::refreshChoiceInfo(){
+	Kernels::choiceInfo(pheromone.data(), visibility.data(), alfa, choiceInfo.data(), pheromone.size());
+}
+
+void ACO::resetPheromone(){
+	if(population>0){
+		//archive is empty, so all arcs have initial pheromone (one)
+		archive.clear();
+		archivedBest.clear();
+		edgeCounts.clear();
+		choiceInfo=visibility;
+		//the other colony deposits the best solution so far in every iteration, so it must stay in archive
+		if(!bestSoFar.second.empty()){
+			archivedBest=bestSoFar.second;
+			countSolution(archivedBest, true);
 		}
+	}else{
+		std::fill(pheromone.begin(), pheromone.end(), initialPheromone);
+		pheromoneScale=1;
+		refreshChoiceInfo();
 	}
-	#endif
+	//choice info could be allocated again
+	choiceData.store(choiceInfo.data(), std::memory_order_release);
+
+	if(!branching.empty()){
+		std::fill(touchedVertex.begin(), touchedVertex.end(), 0);
+		touchedVertices.clear();
+		branchingSum=0;
+		for (unsigned v = 1; v < vertices.size(); v++) {
+			branching[v]=vertexBranching(v);
+			branchingSum+=branching[v];
+		}
+	}
+}
 
-	#ifndef NO_CANDIDATES
+std::uint32_t ACO::vertexBranching(const unsigned v) const{
+	//stored pheromone is enough, because all arcs have the same pheromone scale
+	auto tau=[&](const Candidate& c) -> double{
+		if(population==0) return pheromone[c.arc];
+		const auto count=edgeCounts.find(edgeKey(v, c.vertex));
+		return populationPheromone(count==edgeCounts.end() ? 0 : count->second);
+	};
+
+	double tauMin=std::numeric_limits<double>::infinity();
+	double tauMax=-std::numeric_limits<double>::infinity();
+	for(const Candidate* c=candidatesBegin(v); c!=candidatesEnd(v); ++c){
+		const double t=tau(*c);
+		tauMin=std::min(tauMin, t);
+		tauMax=std::max(tauMax, t);
+	}
 
-	//ok now we have all arcs and their vertices
-	//now its time to sort the arcs in vertices according to distances
-	//and create list of vertices to visit
+	const double threshold=tauMin+BRANCHING_LAMBDA*(tauMax-tauMin);
+	std::uint32_t count=0;
+	for(const Candidate* c=candidatesBegin(v); c!=candidatesEnd(v); ++c){
+		if(tau(*c)>=threshold) count++;
+	}
+	return count;
+}
 
-	for (Vertex& v : vertices) {
+void ACO::updateBranching(){
+	for(unsigned v : touchedVertices){
+		touchedVertex[v]=0;
+		if(v==0) continue;	//depot has all customers as candidates, so it is not counted
+		branchingSum-=branching[v];
+		branching[v]=vertexBranching(v);
+		branchingSum+=branching[v];
+	}
+	touchedVertices.clear();
+}
 
-		if (v.c->type == EnityType::DEPOT)
-			continue;
-		Arc* toDepot = nullptr;
-		for (Arc* a : v.candidates) {
+void ACO::renormalizePheromone(){
+	Kernels::scale(pheromone.data(), pheromone.size(), pheromoneScale.load(std::memory_order_relaxed));
+	pheromoneScale=1;
+	refreshChoiceInfo();
+}
 
-			for (const Vertex* actV : a->v) {
-				if (actV->c->type == EnityType::DEPOT) {
-					toDepot = a;
-					break;
-				}
-			}
-			if (toDepot != nullptr)
-				break;
-		}
+void ACO::evaporate(){
+	const double scale=pheromoneScale.load(std::memory_order_relaxed)*ro;
+	pheromoneScale.store(scale, std::memory_order_relaxed);
 
-		std::sort(v.candidates.begin(), v.candidates.end(),
-				[](const Arc*const a, const Arc*const b) -> bool
-				{	return a->distance < b->distance;});
+	//stored pheromone of deposited arcs grows with 1/pheromoneScale and choice info with its alfa power
+	//so we must return to real values before it overflows
+	if(!(std::pow(scale, std::max(alfa, 1.0))>=MIN_SCALE_POWER)){
+		renormalizePheromone();
+	}
+}
 
-		//filter only the best ones as candidates
-		unsigned selectN =
-				numOfCandidates <= v.candidates.size() ?
-						numOfCandidates : v.candidates.size();
-		if (selectN < v.candidates.size()) {//if is equal than depot must be in and also there is no need for resizing
-			v.candidates.resize(selectN + 1); //+1 because of reserve for depot
-			bool containsDepot = false;
-			//check if depot is in candidate list
-			for (const Arc* a : v.candidates) {
-				for (const Vertex* actV : a->v) {
-					if (actV->c->type == EnityType::DEPOT) {
-						containsDepot = true;
-						goto CONTAINS_DEPOT;
-					}
+void ACO::deposit(const unsigned a, const double delta){
+	//scale is changed only by evaporation and renormalization, in asynchronous colony
+	//evaporation is done in deposit section and renormalization waits until deposits end
+	const double scale=pheromoneScale.load(std::memory_order_relaxed);
+	if(!concurrent){
+		pheromone[a]+=delta/scale;
+		touchedArcs.push_back(a);
+		return;
+	}
+
+	//other threads can deposit on the same arc, so the sum is done with compare and swap
+	double tau=atomicAdd(pheromone[a], delta/scale);
+
+	//ants are reading choice info while we are changing it
+	double choice;
+	Kernels::choiceInfo(&tau, &visibility[a], alfa, &choice, 1);
+	__atomic_store(&choiceInfo[a], &choice, __ATOMIC_RELAXED);
+}
+
+double ACO::atomicAdd(double& target, const double delta){
+	double expected, desired;
+	__atomic_load(&target, &expected, __ATOMIC_RELAXED);
+	do{
+		desired=expected+delta;
+	}while(!__atomic_compare_exchange(&target, &expected, &desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	return desired;
+}
+
+void ACO::enterDeposit(){
+	while(true){
+		depositors++;
+		if(!renormalizing) return;
+		//renormalization is running, lets wait until it ends
+		depositors--;
+		while(renormalizing) std::this_thread::yield();
+	}
+}
+
+void ACO::leaveDeposit(){
+	depositors--;
+}
+
+void ACO::evaporateConcurrent(){
+	enterDeposit();
+	double scale=pheromoneScale.load(std::memory_order_relaxed);
+	double evaporated;
+	do{
+		evaporated=scale*ro;
+	}while(!pheromoneScale.compare_exchange_weak(scale, evaporated, std::memory_order_relaxed));
+	leaveDeposit();
+
+	if(std::pow(evaporated, std::max(alfa, 1.0))>=MIN_SCALE_POWER) return;
+
+	//renormalization needs all arcs, so it waits until running deposits end
+	if(renormalizing.exchange(true)) return;	//other thread is doing it
+	while(depositors>0) std::this_thread::yield();
+
+	scale=pheromoneScale.load(std::memory_order_relaxed);
+	if(!(std::pow(scale, std::max(alfa, 1.0))>=MIN_SCALE_POWER)){
+		Kernels::scale(pheromone.data(), pheromone.size(), scale);
+		pheromoneScale.store(1, std::memory_order_relaxed);
+		//ants are still reading the published choice info, so the new values are calculated in the other buffer,
+		//when ants that acquired it before the last renormalization finish their solutions
+		const unsigned published=choiceSlot.load();
+		const unsigned other=1-published;
+		while(choiceReaders[other]>0) std::this_thread::yield();
+		Kernels::choiceInfo(pheromone.data(), visibility.data(), alfa, choiceBuffers[other], pheromone.size());
+		choiceInfo.swap(choiceScratch);	//choiceInfo has data of choiceBuffers[other] now
+		choiceData.store(choiceInfo.data(), std::memory_order_release);
+		choiceSlot.store(other);
+	}
+	renormalizing=false;
+}
+
+const double* ACO::acquireChoiceInfo(unsigned& slot){
+	slot=0;
+	if(!concurrent) return getChoiceInfo();
+
+	while(true){
+		slot=choiceSlot.load();
+		choiceReaders[slot]++;
+		//renormalization could publish the other buffer before we were counted
+		if(choiceSlot.load()==slot) return choiceBuffers[slot];
+		choiceReaders[slot]--;
+	}
+}
+
+void ACO::releaseChoiceInfo(const unsigned slot){
+	if(concurrent) choiceReaders[slot]--;
+}
+
+unsigned ACO::improveSolutions(std::vector<std::vector<const Vertex*>>& solutions,
+		std::vector<std::pair<double,unsigned>>& sorted, const bool all) const{
+	unsigned improve=sorted.size();
+	if(!all && localSearchAnts>0 && localSearchAnts<improve){
+		improve=localSearchAnts;
+		std::partial_sort(sorted.begin(), sorted.begin()+improve, sorted.end(),
+				[](const std::pair<double,unsigned>& a, const std::pair<double,unsigned>& b) -> bool{
+					return a.first<b.first;
 				}
-			}
-			CONTAINS_DEPOT: if (!containsDepot) {
-				//depot is not in candidates
-				v.candidates.pop_back();
-				//add depot
-				v.candidates.push_back(toDepot);
-			}
+		);
+	}
+	for (unsigned si = 0; si < improve; si++) {
+		twoOpt(solutions[sorted[si].second]);
+		sorted[si].first=solutionCost(solutions[sorted[si].second]);
+	}
+	return improve;
+}
+
+void ACO::depositSolutions(const std::vector<std::vector<const Vertex*>>& solutions,
+		const std::vector<std::pair<double,unsigned>>& elite,
+		const std::pair<double, std::vector<const Vertex*>>& best, const double share){
+	//increase pheromones of visited arcs
+	for (unsigned mi = 0; mi + 1 < elite.size(); mi++) {//we don't want the last one
+		double pDelta = share*(elite.size() - (mi + 1)) / elite[mi].first;
+		const std::vector<const Vertex*>& solution=solutions[elite[mi].second];
+		for (unsigned vi = 0; vi < solution.size() - 1; vi++) {
+			//select arc for update
+			deposit(selectArc(*solution[vi], *solution[vi+1]), pDelta);
+			touchVertex(solution[vi]->c->id);
 		}
+	}
 
+	//increase pheromones for arcs that belongs to best solution so far
+	double pDeltaBest=share*elite.size()/best.first;
+	for (unsigned vi = 0;vi < best.second.size() - 1;vi++) {
+		//select arc for update
+		deposit(selectArc(*(best.second[vi]),*(best.second[vi+1])), pDeltaBest);
+		touchVertex(best.second[vi]->c->id);
 	}
-	#endif
+}
 
+SolveResult ACO::solve(const unsigned iterations){
+	SolveOptions options;
+	options.iterations=iterations;
+	return solve(options);
+}
+
+SolveResult ACO::solveSavings(){
+	const std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+	SolveResult result;
+	stats=SolveStats();
+	routeCache.resetCounters();
+	localSearchNanos=0;
+	candidateLists.clear();
+
+	bestSoFar.second=savingsSolution();
+	#ifndef NO_TWO_OPT
+	twoOpt(bestSoFar.second);
+	#endif
+	bestSoFar.first=solutionCost(bestSoFar.second);
 
+	finishSolve(result);
+	result.elapsed=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+	return result;
 }
 
-void ACO::solve(const unsigned iterations){
-	for(Arc& a : arcs) a.pheromone=100;
+SolveResult ACO::solve(const SolveOptions& options){
+	typedef std::chrono::steady_clock Clock;
+	const Clock::time_point start=Clock::now();
+	auto elapsed=[&start]() -> double{
+		return std::chrono::duration<double>(Clock::now()-start).count();
+	};
+
+	const unsigned iterations=options.iterations>0 ? options.iterations : 2*vrp.getCustomers().size();
+	SolveResult result;
+
+	if(!arcsCreated) arcCreate();
+	if(ants.empty()){
+		//according to paper we are creating one ant at each customer
+		for (unsigned i = 1; i < vertices.size(); i++) { //zero is depot
+			ants.push_back(Ant(&vertices[i], this));
+		}
+	}
+
+	std::random_device rd;
+	for (unsigned i = 0; i < ants.size(); i++) {
+		ants[i].seed(options.seed==0 ? rd() : options.seed+i);
+	}
+
+	//population based colony is always synchronous
+	const bool async=asyncWorkers>0 && population==0;
+
+	//branching factors are tracked only when they are used
+	if(restartBranching>0 && !async){
+		branching.assign(vertices.size(), 0);
+		touchedVertex.assign(vertices.size(), 0);
+	}else{
+		branching.clear();
+		touchedVertex.clear();
+	}
+
+	stats=SolveStats();
+	routeCache.resetCounters();
+	localSearchNanos=0;
 	bestSoFar.first=std::numeric_limits<double>::infinity();
 	bestSoFar.second.clear();
+	initialPheromone=100;
+	if(savingsStart){
+		//colony starts from good solution and pheromone has scale of the problem
+		bestSoFar.second=savingsSolution();
+		#ifndef NO_TWO_OPT
+		twoOpt(bestSoFar.second);
+		#endif
+		bestSoFar.first=solutionCost(bestSoFar.second);
+		if(ro<1) initialPheromone=elitAnts/((1-ro)*bestSoFar.first);
+	}
+	resetPheromone();
+
+	candidateLists.resize(async ? std::min<std::size_t>(asyncWorkers, ants.size()) : 1);
+	for(CandidateLists& l : candidateLists) l.init(*this);
+
+	if(async){
+		result.iterations=solveAsync(options, iterations, result.cancelled);
+		finishSolve(result);
+		result.elapsed=elapsed();
+		return result;
+	}
+
+	std::mt19937 sweepGen(options.seed==0 ? rd() : options.seed+ants.size());
+	std::uniform_real_distribution<double> sweepDist(0,1);
+	unsigned withoutImprovement=0;	//iterations without improvement of the best solution
+
+	double lastReport=-std::numeric_limits<double>::infinity();
+	bool improved=false; //since last report
 
 	//iter
-	for(unsigned i=0; i<iterations; i++ ){
+	unsigned i=0;
+	for(; i<iterations; i++ ){
 		//init iter
+		if(options.cancel!=nullptr && options.cancel->load()){
+			result.cancelled=true;
+			break;
+		}
+		if(options.timeLimit>0 && elapsed()>=options.timeLimit) break;
 
 		std::vector<std::vector<const Vertex*>> iterSolutions;
 
 		std::vector<std::pair<double,unsigned>> sortedSolutions; //cost, solution index
 		//create new solution for each ant
 		for(Ant& a: ants){
-			iterSolutions.push_back(a.genSolution());//every ant creates its solution
-			/*
-			unsigned num=0;
-			for(auto v: iterSolutions.back()){
-				if(v->c->type!=EnityType::DEPOT){
-					num++;
-				}
-			}
-			if(num!=vrp.getCustomers().size())
-				std::cout << "\nERROR HERE: " <<num << std::endl;*/
-
-			#ifndef NO_TWO_OPT
-			//lets try to improve solution with 2-opt heuristic
-			twoOpt(iterSolutions.back());
-			#endif
+			iterSolutions.push_back(a.genSolution(candidateLists[0]));//every ant creates its solution
+			stats.constructions++;
 			sortedSolutions.push_back(std::make_pair(solutionCost(iterSolutions.back()),sortedSolutions.size()));
 		}
+
+		#ifndef NO_TWO_OPT
+		//lets try to improve solutions with 2-opt heuristic
+		//only the best constructed solutions are improved, unless it is time for full sweep
+		const bool fullSweep=(fullSweepProbability>0 && sweepDist(sweepGen)<fullSweepProbability)
+				|| (stagnationSweep>0 && withoutImprovement>=stagnationSweep);
+		if(fullSweep) withoutImprovement=0;
+		const unsigned improvedSolutions=improveSolutions(iterSolutions, sortedSolutions, fullSweep);
+		stats.localSearchSolutions+=improvedSolutions;
+		if(improvedSolutions==sortedSolutions.size()) stats.fullSweeps++;
+		#endif
 		//now we have from every ant one solution for given VRP
 		//improved with 2-opt heuristic
 		//now its time to select the elites ants and update pheromones on searched path
@@ -206,130 +795,322 @@ void ACO::solve(const unsigned iterations){
 			sortedSolutions.resize(elitAnts);
 		}
 
-		if(bestSoFar.first>sortedSolutions[0].first){
+		const bool newBest=bestSoFar.first>sortedSolutions[0].first;
+		if(newBest){
 			//we searched new best
 			bestSoFar=std::make_pair(sortedSolutions[0].first, iterSolutions[sortedSolutions[0].second]);
+			improved=true;
+			withoutImprovement=0;
+		}else{
+			withoutImprovement++;
 		}
 
 		//update pheromones
+		if(population>0){
+			//no evaporation, pheromone changes only on arcs of solutions entering and leaving the archive
+			updateArchive(iterSolutions[sortedSolutions[0].second], newBest);
+		}else{
+			//evaporation
+			touchedArcs.clear();
+			evaporate();
+
+			depositSolutions(iterSolutions, sortedSolutions, bestSoFar, 1);
+
+			//evaporation does not change probabilities so we need to refresh only deposited arcs
+			Kernels::choiceInfo(pheromone.data(), visibility.data(), alfa, choiceInfo.data(),
+					touchedArcs.data(), touchedArcs.size());
+		}
 
-		//evaporation
-		for(Arc& a: arcs) a.pheromone=ro*a.pheromone;
-
-		//increase pheromones of visited arcs
-		for (unsigned mi = 0; mi < sortedSolutions.size() - 1; mi++) {//we don't want the last one
-			double pDelta = (sortedSolutions.size() - (mi + 1))
-					/ sortedSolutions[mi].first;
-			for (unsigned vi = 0;
-					vi < iterSolutions[sortedSolutions[mi].second].size() - 1;
-					vi++) {
-				//select arc for update
-				Arc* a =selectArc(*(iterSolutions[sortedSolutions[mi].second][vi]),
-						*(iterSolutions[sortedSolutions[mi].second][vi+1])
-						);
-
-				a->pheromone += pDelta;
-
+		if(!branching.empty()){
+			//converged colony would only repeat the same solutions
+			updateBranching();
+			//archive with a few solutions (after start or reset) has low branching factor even without stagnation
+			const bool archiveFull=population==0 || archive.size()>=population;
+			if(archiveFull && meanBranching()<restartBranching){
+				resetPheromone();
+				stats.restarts++;
 			}
+		}
 
+		if(options.progress){
+			const double now=elapsed();
+			if(now-lastReport>=options.progressInterval){
+				SolveProgress p;
+				p.iteration=i;
+				p.iterations=iterations;
+				p.bestCost=bestSoFar.first-vrp.getCustomers().size()*vrp.getDropTime();
+				p.elapsed=now;
+				p.improved=improved;
+				p.branching=branching.empty() ? 0 : meanBranching();
+				options.progress(p);
+				lastReport=now;
+				improved=false;
+			}
 		}
+	}
 
-		//increase pheromones for arcs that belongs to best solution so far
-		double pDeltaBest=sortedSolutions.size()/bestSoFar.first;
+	finishSolve(result);
+	result.iterations=i;
+	result.elapsed=elapsed();
+	return result;
+}
 
-		for (unsigned vi = 0;vi < bestSoFar.second.size() - 1;vi++) {
-			//select arc for update
-			Arc* a =selectArc(*(bestSoFar.second[vi]),*(bestSoFar.second[vi+1]));
-			a->pheromone += pDeltaBest;
+unsigned ACO::solveAsync(const SolveOptions& options, const unsigned iterations, bool& cancelled){
+	typedef std::chrono::steady_clock Clock;
+	typedef std::pair<double, std::vector<const Vertex*>> Solution;
+	const Clock::time_point start=Clock::now();
+	auto elapsed=[&start]() -> double{
+		return std::chrono::duration<double>(Clock::now()-start).count();
+	};
+
+	const unsigned workers=std::min<std::size_t>(asyncWorkers, ants.size());
+	const unsigned long long epochLength=ants.size();	//one epoch has as many constructions as one iteration
+
+	//published best solution, workers are replacing it with compare and swap
+	std::shared_ptr<const Solution> best=std::make_shared<const Solution>(bestSoFar);
+
+	std::atomic<unsigned long long> constructions(0);
+	std::atomic<bool> stop(false);
+	std::atomic<bool> cancel(false);
+	std::atomic<bool> improved(false);
+	std::mutex lock;	//guards progress reporting, statistics and error
+	double lastReport=-std::numeric_limits<double>::infinity();
+	std::exception_ptr error;
+
+	std::random_device rd;
+	std::vector<unsigned> seeds;
+	for (unsigned w = 0; w < workers; w++) {
+		seeds.push_back(options.seed==0 ? rd() : options.seed+ants.size()+w);
+	}
 
-		}
-		std::cout << i << ". ITER best so far: " << bestSoFar.first-vrp.getCustomers().size()*vrp.getDropTime() <<std::endl;
-		/*
-		double length=0;
-		double carry=0;
-		const Vertex * before=nullptr;
+	depositors=0;
+	renormalizing=false;
+	//both buffers of choice info are allocated before workers start, so their addresses do not change
+	choiceScratch.resize(choiceInfo.size());
+	choiceBuffers[0]=choiceInfo.data();
+	choiceBuffers[1]=choiceScratch.data();
+	choiceSlot=0;
+	choiceReaders[0]=0;
+	choiceReaders[1]=0;
+	concurrent=true;
+
+	auto worker=[&](const unsigned w){
+		//worker owns every workers-th ant
+		std::vector<Ant*> own;
+		for (unsigned a = w; a < ants.size(); a+=workers) own.push_back(&ants[a]);
+		//deposits of one batch are weighted by its share of the whole colony
+		const double share=static_cast<double>(own.size())/ants.size();
+
+		std::mt19937 sweepGen(seeds[w]);
+		std::uniform_real_distribution<double> sweepDist(0,1);
+		unsigned withoutImprovement=0;	//batches without improvement of the best solution
+		SolveStats local;
+
+		try{
+			while(!stop){
+				if(options.cancel!=nullptr && options.cancel->load()){
+					cancel=true;
+					stop=true;
+					break;
+				}
+				if(options.timeLimit>0 && elapsed()>=options.timeLimit){
+					stop=true;
+					break;
+				}
 
+				std::vector<std::vector<const Vertex*>> solutions;
+				std::vector<std::pair<double,unsigned>> sorted; //cost, solution index
+				for(Ant* a : own){
+					solutions.push_back(a->genSolution(candidateLists[w]));
+					sorted.push_back(std::make_pair(solutionCost(solutions.back()), sorted.size()));
+				}
+				local.constructions+=own.size();
+
+				#ifndef NO_TWO_OPT
+				const bool fullSweep=(fullSweepProbability>0 && sweepDist(sweepGen)<fullSweepProbability)
+						|| (stagnationSweep>0 && withoutImprovement>=stagnationSweep);
+				if(fullSweep) withoutImprovement=0;
+				const unsigned improvedSolutions=improveSolutions(solutions, sorted, fullSweep);
+				local.localSearchSolutions+=improvedSolutions;
+				if(improvedSolutions==sorted.size()) local.fullSweeps++;
+				#endif
+
+				std::sort(sorted.begin(), sorted.end(),
+						[](const std::pair<double,unsigned>& a, const std::pair<double,unsigned>& b) -> bool{
+							return a.first<b.first;
+						}
+				);
+				if(sorted.size()>elitAnts) sorted.resize(elitAnts);
+
+				//publish new best solution
+				std::shared_ptr<const Solution> actualBest=std::atomic_load(&best);
+				if(actualBest->first>sorted[0].first){
+					std::shared_ptr<const Solution> candidate=std::make_shared<const Solution>(
+							sorted[0].first, solutions[sorted[0].second]);
+					while(actualBest->first>candidate->first
+							&& !std::atomic_compare_exchange_weak(&best, &actualBest, candidate));
+					if(std::atomic_load(&best)==candidate){
+						improved=true;
+						withoutImprovement=0;
+					}
+				}else{
+					withoutImprovement++;
+				}
 
+				enterDeposit();
+				depositSolutions(solutions, sorted, *std::atomic_load(&best), share);
+				leaveDeposit();
 
-		for(auto v: bestSoFar.second){
-			if(before!=nullptr) length+=before->distToVertex(*v);
-			if(v->c->type==EnityType::DEPOT){
-				if(before!=nullptr) std::cout << "-> (" << before->distToVertex(*v) << ") -> "<<v->c->id;
-				std::cout <<std::endl;
-				std::cout << "\t Route time: " << length << std::endl;
-				std::cout << "\t Carry: " << carry << std::endl;
-				length=0;
-				carry=0;
-			}else{
+				//evaporation is done once per epoch by the worker that finished it
+				const unsigned long long before=constructions.fetch_add(own.size());
+				const unsigned long long after=before+own.size();
+				for (unsigned long long e = before/epochLength; e < after/epochLength; e++) {
+					evaporateConcurrent();
+				}
 
-				std::cout << "-> (" << before->distToVertex(*v) << ") -> ";
-				std::cout << v->c->id;
-				carry+=v->c->quantity;
-				length+=vrp.getDropTime();
+				const unsigned long long epochs=after/epochLength;
+				if(epochs>=iterations) stop=true;
+				if(options.progress && epochs>before/epochLength){
+					std::lock_guard<std::mutex> guard(lock);
+					const double now=elapsed();
+					if(now-lastReport>=options.progressInterval){
+						SolveProgress p;
+						p.iteration=std::min<unsigned long long>(epochs, iterations)-1;
+						p.iterations=iterations;
+						p.bestCost=std::atomic_load(&best)->first-vrp.getCustomers().size()*vrp.getDropTime();
+						p.elapsed=now;
+						p.improved=improved.exchange(false);
+						options.progress(p);
+						lastReport=now;
+					}
+				}
 			}
-			before=v;
+		}catch(...){
+			std::lock_guard<std::mutex> guard(lock);
+			if(!error) error=std::current_exception();
+			stop=true;
 		}
-		std::cout << "len (without drop time): " << bestSoFar.first-vrp.getCustomers().size()*vrp.getDropTime() << std::endl;
 
-		std::cout << "NUM OF CUSTOMERS " << vrp.getCustomers().size() << std::endl;
-		std::cout << "CAPACITY " << vrp.getVehicleCapacity() << std::endl;
-		std::cout << "MAX TIME " << vrp.getMaxRouteTime() << std::endl;
-		std::cout << "DROP TIME " << vrp.getDropTime() << std::endl;
+		std::lock_guard<std::mutex> guard(lock);
+		stats+=local;
+	};
 
-		*/
+	std::vector<std::thread> threads;
+	for (unsigned w = 1; w < workers; w++) threads.push_back(std::thread(worker, w));
+	worker(0);
+	for(std::thread& t : threads) t.join();
+	concurrent=false;
 
-	}
+	if(error) std::rethrow_exception(error);
+
+	bestSoFar=*best;
+	cancelled=cancel;
+	return std::min<unsigned long long>(constructions/epochLength, iterations);
+}
 
+void ACO::finishSolve(SolveResult& result){
 	bestSoFar.first=bestSoFar.first-vrp.getCustomers().size()*vrp.getDropTime();
+
+	stats.nearestFallbacks=0;
+	stats.lateReturns=0;
+	for(const CandidateLists& l : candidateLists){
+		stats.nearestFallbacks+=l.fallbacks;
+		stats.lateReturns+=l.lateReturns;
+	}
+	stats.routeCacheHits=routeCache.getHits();
+	stats.routeCacheMisses=routeCache.getMisses();
+	stats.localSearchTime=localSearchNanos/1e9;
+	if(stats.routeCacheMisses>0){
+		//hit would cost the same as the average miss
+		stats.localSearchTimeSaved=stats.localSearchTime*stats.routeCacheHits/stats.routeCacheMisses;
+	}
+
+	result.cost=bestSoFar.first;
+	for(const Vertex* v : bestSoFar.second){
+		if(v->c->type==EnityType::DEPOT){
+			if(!result.routes.empty() && result.routes.back().empty()) continue;
+			result.routes.push_back(std::vector<unsigned>());
+		}else{
+			result.routes.back().push_back(v->c->id);
+		}
+	}
+	if(!result.routes.empty() && result.routes.back().empty()) result.routes.pop_back();
+	result.stats=stats;
 }
 
 Ant::Ant(const Vertex* iV, ACO* aco):initVertex(iV), parentACO(aco), dist(0,1) {}
 
 void Ant::returnToDepot(){
-	while (route.size() > 0 && route.back()->distToDepot() + time > parentACO->getVrp().getMaxRouteTime()) {
-		//we must return because distance to depot exceeds route length limit
-		if (route.size() > 1) {
-			time -= parentACO->getVrp().getDropTime();
-			time -= route.back()->distToVertex(*(route[route.size() - 2]));
-			filledCapacity -= route.back()->c->quantity;
-		}
-		tabu.erase(route.back());
-		route.pop_back();
-	}
-	if (route.size() > 0) {
-		//add depot
-		route.push_back(&(parentACO->getVertices()[0]));
-
-		//we are in depot so we can reset these
-		filledCapacity = 0;
-		time = 0;
-	} else {
+	if (route.back()->c->type == EnityType::DEPOT) {
+		//we are in depot and there is no customer that we can visit and return back in time
 		throw std::runtime_error(
 				"Maximum route time is too small. Vehicles can not visit some customers.");
 	}
+	//return to depot in time was checked when last customer was selected (see nextVisit)
+	route.push_back(&(parentACO->getVertices()[0]));
+
+	//we are in depot so we can reset these
+	filledCapacity = 0;
+	time = 0;
+}
+
+std::vector<const Vertex*> Ant::genGiantTour(CandidateLists& lists){
+	route.clear();
+	lists.reset();
+
+	route.push_back(initVertex);
+	lists.visit(initVertex->c->id);
+
+	while(lists.getVisitedCount()<parentACO->getVrp().getCustomers().size()){
+		const Vertex* nextVertex = nextVisit(lists, true);
+		if (nextVertex == nullptr) {
+			//if we are here than something is rotten in the state of this program
+			throw std::runtime_error("Unexpected error when creating giant tour.");
+		}
+		route.push_back(nextVertex);
+		lists.visit(nextVertex->c->id);
+	}
+
+	return parentACO->split(route);
 }
 
-std::vector<const Vertex*> Ant::genSolution(){
+std::vector<const Vertex*> Ant::genSolution(CandidateLists& lists){
+	//choice info is released also when construction fails
+	struct Reader{
+		ACO& aco;
+		unsigned slot;
+		const double* data;
+		Reader(ACO& aco) :aco(aco), slot(0), data(aco.acquireChoiceInfo(slot)) {}
+		~Reader(){
+			aco.releaseChoiceInfo(slot);
+		}
+	} reader(*parentACO);
+	choiceInfo=reader.data;
+
+	if(parentACO->getGiantTour()) return genGiantTour(lists);
+
 	route.clear();
-	tabu.clear();
+	lists.reset();
 
 	//add init vertex and depot
 	route.push_back(&(parentACO->getVertices()[0]));
 	route.push_back(initVertex);
-	randGen.seed(std::random_device()());
 	filledCapacity=initVertex->c->quantity;
 
 	//search distance from depot
 	time=initVertex->distToDepot();
 	//add drop time
 	time+=parentACO->getVrp().getDropTime();
-	//add it to tabu
-	tabu.insert(initVertex);
+	if(time+initVertex->distToDepot()>parentACO->getVrp().getMaxRouteTime()){
+		throw std::runtime_error(
+				"Maximum route time is too small. Vehicles can not visit some customers.");
+	}
+	//mark it as visited
+	lists.visit(initVertex->c->id);
 
-	START_AGAIN:
-	while(tabu.size()<parentACO->getVrp().getCustomers().size()){//if we need to visit some customer
+	while(lists.getVisitedCount()<parentACO->getVrp().getCustomers().size()){//if we need to visit some customer
 		//find next visit
-		const Vertex* nextVertex = nextVisit();
+		const Vertex* nextVertex = nextVisit(lists);
 
 		if (nextVertex == nullptr) {
 			//can not find feasible vertex
@@ -347,109 +1128,191 @@ std::vector<const Vertex*> Ant::genSolution(){
 
 
 			route.push_back(nextVertex);
-			//add it to tabu
-			tabu.insert(nextVertex);
+			//mark it as visited
+			lists.visit(nextVertex->c->id);
 
 		}
 	}
 	if(route.back()->c->type!=EnityType::DEPOT){
 		//ok we visited all customers but we need to return to depot
 		returnToDepot();
-		if(tabu.size()<parentACO->getVrp().getCustomers().size()){
-			//ok we lost some costumers
-			goto START_AGAIN;
-		}
 	}
 
 	return route;
 
 }
 
-const Vertex* Ant::nextVisit(){
-	//filter feasible vertices
-	std::vector<const Vertex*> vert;
-	std::vector<const Arc*> arcs; //corresponding arcs to selected vertices
-	for(const Arc* a: route.back()->candidates){//candidates from previous vertex
-		for(const Vertex* v : a->v){
-			if (v!=route.back()){
-				if(tabu.find(v) == tabu.end() ){
-					//Arc contains actual vertex and possible next vertex and we just filtered actual and
-					//next is not a tabu.
-					if(v->c->type!=EnityType::DEPOT){//we are skipping depot
-
-						if(v->c->quantity+filledCapacity<=parentACO->getVrp().getVehicleCapacity()){
-							//we have enough capacity
-
-							if(a->distance+time+parentACO->getVrp().getDropTime()
-									<=parentACO->getVrp().getMaxRouteTime()){
-								//we are in route time
-								//we can compare distance with time because we are assuming that
-								//vehicle velocity is one distance unit per one time unit
-								vert.push_back(v);
-								arcs.push_back(a);
-							}
+bool Ant::fits(const Vertex& v, const double distance) const{
+	const VRP& vrp=parentACO->getVrp();
+	//we can compare distance with time because we are assuming that
+	//vehicle velocity is one distance unit per one time unit
+	//we must be able to return to depot in time, so route will never be shortened
+	return v.c->quantity+filledCapacity<=vrp.getVehicleCapacity()
+			&& time+distance+vrp.getDropTime()+v.distToDepot()<=vrp.getMaxRouteTime();
+}
 
-						}
-					}
-				}
-				break;
+const Vertex* Ant::nearestFeasible(CandidateLists& lists){
+	const Grid& grid=parentACO->getGrid();
+	const std::vector<Vertex>& vertices=parentACO->getVertices();
+	const VRP& vrp=parentACO->getVrp();
+	const Vertex& actual=*route.back();
+	const int cx=grid.column(actual.c->p.x);
+	const int cy=grid.row(actual.c->p.y);
+	const int width=grid.width, height=grid.height;
+
+	//feasible customers and their distances
+	//customer farther than depot is left for a new route (it is cheaper than long detour)
+	std::vector<Candidate>& found=lists.use;
+	std::vector<double>& distances=lists.choice;
+	found.clear();
+	distances.clear();
+	double nearestDist=std::numeric_limits<double>::infinity();
+
+	auto searchCell=[&](const int x, const int y){
+		if(x<0 || y<0 || x>=width || y>=height) return;
+		const unsigned c=y*width+x;
+		if(lists.cellBegin(c)==lists.cellEnd(c) || lists.cellMinDemand(c)+filledCapacity>vrp.getVehicleCapacity()) return;
+		for(const std::uint32_t* i=lists.cellBegin(c); i!=lists.cellEnd(c); ++i){
+			const Vertex& v=vertices[*i];
+			const double d=actual.distToVertex(v);
+			if(d<=FALLBACK_RADIUS*nearestDist && d<=actual.distToDepot() && fits(v, d)){
+				found.push_back(Candidate{*i, 0});	//choice info is read by vertices (see ACO::arcChoice)
+				distances.push_back(d);
+				nearestDist=std::min(nearestDist, d);
 			}
 		}
+	};
+
+	//rings of cells around actual cell, customers in ring r are at least (r-1)*cellSize far
+	const int rings=std::max(std::max(cx, width-1-cx), std::max(cy, height-1-cy));
+	for (int r = 0; r <= rings; r++) {
+		//customers farther than depot are not used, so rings behind it are not searched
+		const double lowerBound=(r-1)*grid.cellSize;
+		if(lowerBound>FALLBACK_RADIUS*nearestDist || lowerBound>actual.distToDepot()
+				|| time+lowerBound+vrp.getDropTime()>vrp.getMaxRouteTime()) break;
+		if(r==0){
+			searchCell(cx, cy);
+			continue;
+		}
+		for (int x = cx-r; x <= cx+r; x++) {
+			searchCell(x, cy-r);
+			searchCell(x, cy+r);
+		}
+		for (int y = cy-r+1; y < cy+r; y++) {
+			searchCell(cx-r, y);
+			searchCell(cx+r, y);
+		}
 	}
+	if(found.empty()) return nullptr;
+	lists.fallbacks++;
 
-	//we need to get probabilities for rulete
-	if(vert.size()==0) return nullptr;
+	//roulette over customers that are not much farther than the nearest one
+	double sum=0;
+	unsigned kept=0;
+	for (unsigned i = 0; i < found.size(); i++) {
+		if(distances[i]>FALLBACK_RADIUS*nearestDist) continue;
+		const double p=parentACO->arcChoice(actual.c->id, found[i].vertex, choiceInfo);
+		found[kept]=found[i];
+		distances[kept]=p;
+		sum+=p;
+		kept++;
+	}
 
-	//do sum of all probabilities
+	double shoot=dist(randGen)*sum;
+	for (unsigned i = 0; i < kept; i++) {
+		shoot-=distances[i];
+		if(shoot<=0) return &vertices[found[i].vertex];
+	}
+	//zero probabilities or rounding, lets take the nearest one
+	for (unsigned i = 0; i < kept; i++) {
+		if(actual.distToVertex(vertices[found[i].vertex])==nearestDist) return &vertices[found[i].vertex];
+	}
+	return &vertices[found[0].vertex];
+}
+
+const Vertex* Ant::nextVisit(CandidateLists& lists, const bool unconstrained){
+	const std::vector<Vertex>& vertices=parentACO->getVertices();
+	const unsigned actual=route.back()->c->id;	//vertex index is the same as id of its entity
+
+	std::vector<Candidate>& use=lists.use;	//candidates for roulette and corresponding arcs
+	std::vector<double>& choice=lists.choice;
+	use.clear();
+	choice.clear();
 	double sum=0;
 
-	std::vector<const Arc*> arcsUse; //last filter according to probability
+	//choice info of arc that was not deposited for long time underflows to zero,
+	//such arcs are used only when there is nothing else (the nearest one)
+	const Vertex* nearestZero=nullptr;
+	double nearestZeroDist=std::numeric_limits<double>::infinity();
 
-	//std::cout << "ARCS "<< arcs.size() << std::endl;
-	for(auto a : arcs){
-		//std::cout << "P "<< a->pheromone << " V " << a->visibility << std::endl;
-		//std::cout << "\tP "<< std::pow(a->pheromone, parentACO->getAlfa()) << " V " << std::pow(a->visibility, parentACO->getBeta()) << std::endl;
-		double p=std::pow(a->pheromone, parentACO->getAlfa())*a->visibility;
+	auto add=[&](const Candidate& c, const double p){
 		if(p>0){
-			sum+=p; //power for visibility is precalculated
-			arcsUse.push_back(a);
+			sum+=p;
+			use.push_back(c);
+			choice.push_back(p);
+		}else{
+			const double d=route.back()->distToVertex(vertices[c.vertex]);
+			if(d<nearestZeroDist){
+				nearestZeroDist=d;
+				nearestZero=&vertices[c.vertex];
+			}
+		}
+	};
+
+	//lists contain only not visited vertices
+	for(const Candidate* cand=lists.begin(actual); cand!=lists.end(actual); ++cand){//candidates from previous vertex
+		if(cand->vertex==0) continue;	//we are skipping depot
+		const Vertex& v=vertices[cand->vertex];
+		if(unconstrained || fits(v, parentACO->getDistance()[cand->arc])){
+			double p; //pheromone^alfa*visibility is precalculated
+			__atomic_load(&choiceInfo[cand->arc], &p, __ATOMIC_RELAXED);
+			add(*cand, p);
+		}else if(v.c->quantity+filledCapacity<=parentACO->getVrp().getVehicleCapacity()){
+			//it fits to vehicle, so it was rejected because of return to depot in time
+			lists.lateReturns++;
 		}
 	}
 
-	if(arcsUse.size()==0) return nullptr; //we have arcs with zero or smaller probability only
+	if(use.size()==0){
+		if(unconstrained){
+			//all candidates were visited, but giant tour must continue, so lets use all not visited customers
+			//(depot has all customers as candidates)
+			for(const Candidate* cand=lists.begin(0); cand!=lists.end(0); ++cand){
+				add(*cand, parentACO->arcChoice(actual, cand->vertex, choiceInfo));
+			}
+		}else if(actual!=0 && nearestZero==nullptr){
+			//no candidate can be visited, but some other customer can fit to the route
+			//(depot has all customers as candidates, so it has nothing to find)
+			return nearestFeasible(lists);
+		}
+	}
+
+	//we have no feasible vertex or arcs with zero probability only
+	if(use.size()==0) return nearestZero;
 
 	double shoot=dist(randGen); //load gun
 
 	double probSum=0;
 
-	unsigned i=0;
+	for(unsigned u=0; u<use.size(); u++){
 
-
-
-
-	for(auto a : arcsUse){
-
-		probSum+=(std::pow(a->pheromone, parentACO->getAlfa())*a->visibility)/sum; //power for visibility is precalculated
+		probSum+=choice[u]/sum; //pheromone^alfa*visibility is precalculated
 
 		if(probSum>=shoot){
-			//std::cout << "\tSELECTED "<< vert[i]->c->id << " FROM " << route.back()->c->id << " SHOOT " << shoot << " PROB SUM " << probSum << " SUM " << sum << std::endl;
 			//we shoot in that range
-			return vert[i];
+			return &vertices[use[u].vertex];
 		}
-		i++;
 	}
 	std::cerr << "PROB SUM " << probSum << std::endl;
 	std::cerr << "shoot " << shoot << std::endl;
 	std::cerr << "sum " << sum << std::endl;
-	for(auto a : arcsUse){
-
-			std::cerr << "\t" << std::pow(a->pheromone, parentACO->getAlfa())*a->visibility << std::endl;
-			std::cerr << "\t\t";
-			for(auto v: a->v){
-				std::cerr << v->c->id << ", ";
+	for(unsigned u=0; u<use.size(); u++){
+			std::cerr << "\t" << choice[u] << std::endl;
+			std::cerr << "\t\t" << actual << ", " << use[u].vertex << std::endl;
+			if(parentACO->getPopulation()==0){
+				const unsigned arc=parentACO->edgeIndex(actual, use[u].vertex);
+				std::cerr << "\t\t" << parentACO->getPheromone()[arc]*parentACO->getPheromoneScale() << "\t" << parentACO->getVisibility()[arc] << std::endl;
 			}
-			std::cerr << std::endl;
-			std::cerr << "\t\t" << a->pheromone << "\t" << a->visibility << std::endl;
 		}
 	//if we are here than something is rotten in the state of this program
 	throw std::runtime_error("Unexpected error when selecting next vertex.");
@@ -457,6 +1320,214 @@ const Vertex* Ant::nextVisit(){
 }
 
 
+std::vector<const Vertex*> ACO::split(const std::vector<const Vertex*>& tour) const{
+	const unsigned n=tour.size();
+	const double maxTime=vrp.getMaxRouteTime();
+	const double dropTime=vrp.getDropTime();
+
+	//prefix sums over the tour (index k means first k customers)
+	std::vector<double> dist(n+1, 0);	//distance traveled from first to k-th customer
+	std::vector<unsigned long long> load(n+1, 0);
+	for(unsigned k=1; k<=n; k++){
+		load[k]=load[k-1]+tour[k-1]->c->quantity;
+		if(k>1) dist[k]=dist[k-1]+tour[k-2]->distToVertex(*tour[k-1]);
+	}
+
+	//cost[j] is the cost of the best split of first j customers
+	//route of customers i+1..j costs: d0(i+1) + dist[j]-dist[i+1] + d0(j) (drop time is the same for every split)
+	std::vector<double> cost(n+1, std::numeric_limits<double>::infinity());
+	std::vector<unsigned> pred(n+1, 0);
+	cost[0]=0;
+
+	//part of route cost that depends on start of route only
+	auto key=[&](const unsigned i) -> double{
+		return cost[i]+tour[i]->distToDepot()-dist[i+1];
+	};
+	auto feasible=[&](const unsigned i, const unsigned j) -> bool{
+		return load[j]-load[i]<=vrp.getVehicleCapacity()
+			&& tour[i]->distToDepot()+dist[j]-dist[i+1]+tour[j-1]->distToDepot()+dropTime*(j-i)<=maxTime;
+	};
+
+	//Route ends are processed in order. If route i+1..j is infeasible, than every route
+	//that starts before i+1 or ends after j is also infeasible (triangle inequality).
+	//So the feasible starts make sliding window and the best one is kept at front of
+	//monotone queue (increasing key).
+	std::deque<unsigned> starts;
+	starts.push_back(0);
+	for(unsigned j=1; j<=n; j++){
+		while(!starts.empty() && !feasible(starts.front(), j)) starts.pop_front();
+		if(starts.empty()){
+			throw std::runtime_error(
+					"Maximum route time or capacity is too small. Vehicles can not visit some customers.");
+		}
+		pred[j]=starts.front();
+		cost[j]=key(pred[j])+dist[j]+tour[j-1]->distToDepot();
+
+		if(j<n){
+			while(!starts.empty() && key(starts.back())>=key(j)) starts.pop_back();
+			starts.push_back(j);
+		}
+	}
+
+	//create routes from the end
+	std::vector<unsigned> breaks;
+	for(unsigned j=n; j>0; j=pred[j]) breaks.push_back(j);
+
+	std::vector<const Vertex*> solution;
+	solution.reserve(n+breaks.size()+1);
+	solution.push_back(&vertices[0]);
+	unsigned from=0;
+	for(auto it=breaks.rbegin(); it!=breaks.rend(); ++it){
+		for(unsigned k=from; k<*it; k++) solution.push_back(tour[k]);
+		solution.push_back(&vertices[0]);
+		from=*it;
+	}
+
+	return solution;
+}
+
+std::vector<const Vertex*> ACO::savingsSolution() const{
+	const unsigned n=vertices.size();
+
+	struct Saving{
+		double value;
+		std::uint32_t i, j;
+		bool operator<(const Saving& o) const {
+			return value<o.value;
+		}
+	};
+
+	//savings of customer i with its nearest customers, calculated as visibility with g=1 and f=0
+	std::vector<Saving> heap;
+	std::vector<std::uint32_t> near;
+	std::vector<double> d0, dist, values;
+	for (unsigned i = 1; i < n; i++) {
+		nearestCustomers(i, SAVINGS_NEIGHBOURS, near);
+
+		d0.clear();
+		dist.clear();
+		for(std::uint32_t j : near){
+			d0.push_back(vertices[j].depotDistance);
+			dist.push_back(vertices[i].distToVertex(vertices[j]));
+		}
+		values.resize(near.size());
+		Kernels::savings(d0.data(), dist.data(), vertices[i].depotDistance, 1, 0, values.data(), near.size());
+		for (unsigned c = 0; c < near.size(); c++) {
+			if(values[c]>0) heap.push_back(Saving{values[c], i, near[c]});
+		}
+	}
+	std::make_heap(heap.begin(), heap.end());
+
+	//every customer starts on its own route, routes are paths of customers linked to their neighbours
+	//(0 means depot) and data of route are in its root (union find)
+	std::vector<std::uint32_t> first(n, 0), second(n, 0), root(n);
+	std::vector<unsigned long long> load(n);
+	std::vector<double> time(n);
+	for (unsigned i = 1; i < n; i++) {
+		root[i]=i;
+		load[i]=vertices[i].c->quantity;
+		time[i]=2*vertices[i].depotDistance+vrp.getDropTime();
+		if(load[i]>vrp.getVehicleCapacity() || time[i]>vrp.getMaxRouteTime()){
+			throw std::runtime_error(
+					"Maximum route time or capacity is too small. Vehicles can not visit some customers.");
+		}
+	}
+	auto find=[&root](unsigned v) -> unsigned{
+		while(root[v]!=v){
+			root[v]=root[root[v]];
+			v=root[v];
+		}
+		return v;
+	};
+
+	while(!heap.empty()){
+		std::pop_heap(heap.begin(), heap.end());
+		const Saving s=heap.back();
+		heap.pop_back();
+
+		//only ends of two different routes can be joined
+		if((first[s.i]!=0 && second[s.i]!=0) || (first[s.j]!=0 && second[s.j]!=0)) continue;
+		const unsigned ri=find(s.i), rj=find(s.j);
+		if(ri==rj) continue;
+		const double joinedTime=time[ri]+time[rj]-s.value;
+		if(load[ri]+load[rj]>vrp.getVehicleCapacity() || joinedTime>vrp.getMaxRouteTime()) continue;
+
+		(first[s.i]==0 ? first[s.i] : second[s.i])=s.j;
+		(first[s.j]==0 ? first[s.j] : second[s.j])=s.i;
+		root[rj]=ri;
+		load[ri]+=load[rj];
+		time[ri]=joinedTime;
+	}
+
+	//walk every route from one of its ends
+	std::vector<const Vertex*> solution;
+	solution.reserve(2*n);
+	solution.push_back(&vertices[0]);
+	std::vector<char> done(n, 0);
+	for (unsigned v = 1; v < n; v++) {
+		if(done[v] || (first[v]!=0 && second[v]!=0)) continue;
+		for(unsigned previous=0, actual=v; actual!=0; ){
+			done[actual]=1;
+			solution.push_back(&vertices[actual]);
+			const unsigned next=first[actual]!=previous ? first[actual] : second[actual];
+			previous=actual;
+			actual=next;
+		}
+		solution.push_back(&vertices[0]);
+	}
+	return solution;
+}
+
+void ACO::nearestCustomers(const unsigned v, const unsigned k, std::vector<std::uint32_t>& nearest) const{
+	nearest.clear();
+	if(grid.customers.empty() || k==0) return;
+
+	const Vertex& actual=vertices[v];
+	const int cx=grid.column(actual.c->p.x);
+	const int cy=grid.row(actual.c->p.y);
+	const int width=grid.width, height=grid.height;
+	std::vector<std::pair<double, std::uint32_t>> found;
+
+	auto searchCell=[&](const int x, const int y){
+		if(x<0 || y<0 || x>=width || y>=height) return;
+		const unsigned c=y*width+x;
+		for (std::uint32_t i = grid.cellOffsets[c]; i < grid.cellOffsets[c+1]; i++) {
+			const std::uint32_t u=grid.customers[i];
+			if(u!=v) found.push_back(std::make_pair(actual.distToVertex(vertices[u]), u));
+		}
+	};
+
+	//rings of cells around actual cell, customers in ring r are at least (r-1)*cellSize far
+	const int rings=std::max(std::max(cx, width-1-cx), std::max(cy, height-1-cy));
+	for (int r = 0; r <= rings; r++) {
+		if(r==0){
+			searchCell(cx, cy);
+		}else{
+			for (int x = cx-r; x <= cx+r; x++) {
+				searchCell(x, cy-r);
+				searchCell(x, cy+r);
+			}
+			for (int y = cy-r+1; y < cy+r; y++) {
+				searchCell(cx-r, y);
+				searchCell(cx+r, y);
+			}
+		}
+
+		//the next ring can not contain closer customer than the k-th one
+		if(found.size()>=k){
+			std::nth_element(found.begin(), found.begin()+k-1, found.end());
+			if(found[k-1].first<=r*grid.cellSize) break;
+		}
+	}
+
+	if(found.size()>k){
+		std::nth_element(found.begin(), found.begin()+k-1, found.end());
+		found.resize(k);
+	}
+	std::sort(found.begin(), found.end());
+	for(const std::pair<double, std::uint32_t>& f : found) nearest.push_back(f.second);
+}
+
 void ACO::twoOpt(std::vector<const Vertex*>& solution) const{
 	//we are optimizing each vehicle route separately
 
@@ -464,46 +1535,144 @@ void ACO::twoOpt(std::vector<const Vertex*>& solution) const{
 	for(unsigned i=1; i < solution.size();i++){
 		if(solution[i]->c->type==EnityType::DEPOT){
 			//end of one vehicle route
+			improveRoute(solution, routeStart, i);
+			routeStart=i+1;
+		}
 
-			//we can not swap depot so lets not calculate it in cost
-			double bestCost=solutionCost(solution, routeStart, i-1);
+	}
 
+}
 
-		  IMPROVED_START_AGAIN://until no improvement is made
-			for (unsigned x = routeStart; x < i; x++) {
-				for (unsigned y = x + 1; y < i; y++) {
-					std::vector<const Vertex*> newRoute;
+void ACO::improveRoute(std::vector<const Vertex*>& solution, const unsigned routeStart, const unsigned routeEnd) const{
+	//order of one or two customers can not be improved
+	if(routeEnd-routeStart<3) return;
 
-					//swap
-					//first part add in order
-					for (unsigned s = routeStart; s < x; s++) {
-						newRoute.push_back(solution[s]);
-					}
-					//middle part add in reverse order (swapping)
-					for (unsigned s = y; s >= x; s--) {
-						newRoute.push_back(solution[s]);
-					}
-					//middle part add in reverse order (swapping)
-					for (unsigned s = y + 1; s < i; s++) {
-						newRoute.push_back(solution[s]);
-					}
+	RouteCache::Key key;
+	for (unsigned s = routeStart; s < routeEnd; s++) key.add(solution[s]->c->id, solution[s]->c->quantity);
 
-					double actCost = solutionCost(newRoute);
-					if (actCost < bestCost) {
-						//change vehicle route
-						for (unsigned s = routeStart; s < i; s++)
-							solution[s] = newRoute[s - routeStart];
-						bestCost = actCost;
-						goto IMPROVED_START_AGAIN;
-					}
+	std::vector<unsigned> order;
+	if(routeCache.lookup(key, order)){
+		//the same customers were already optimized
+		for (unsigned s = routeStart; s < routeEnd; s++) solution[s]=&vertices[order[s-routeStart]];
+		return;
+	}
+
+	auto start=std::chrono::steady_clock::now();
+	if(routeEnd-routeStart<=exactRouteSize){
+		exactRoute(solution, routeStart, routeEnd);
+	}else{
+		twoOptRoute(solution, routeStart, routeEnd);
+	}
+	localSearchNanos+=std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count();
+
+	order.clear();
+	for (unsigned s = routeStart; s < routeEnd; s++) order.push_back(solution[s]->c->id);
+	routeCache.store(key, order);
+}
+
+void ACO::exactRoute(std::vector<const Vertex*>& solution, const unsigned routeStart, const unsigned routeEnd) const{
+	const unsigned k=routeEnd-routeStart;	//number of customers
+	const unsigned full=(1u<<k)-1;
+
+	//tables are allocated once for every thread and reused for all routes
+	thread_local std::vector<double> cost;	//cost[mask*k+j]: from depot over customers in mask, ends in j
+	thread_local std::vector<std::uint8_t> previous;	//customer before j in the best path
+	thread_local std::vector<double> d;	//distances between route vertices, index 0 is depot
+	const std::size_t size=static_cast<std::size_t>(1u<<exactRouteSize)*exactRouteSize;
+	if(cost.size()<size){
+		cost.resize(size);
+		previous.resize(size);
+	}
+	d.resize((k+1)*(k+1));
+
+	for (unsigned a = 0; a <= k; a++) {
+		const unsigned va=a==0 ? 0 : solution[routeStart+a-1]->c->id;
+		d[a*(k+1)+a]=0;
+		for (unsigned b = a+1; b <= k; b++) {
+			const unsigned vb=solution[routeStart+b-1]->c->id;
+			d[a*(k+1)+b]=d[b*(k+1)+a]=arcDistance(va, vb);
+		}
+	}
+
+	const double inf=std::numeric_limits<double>::infinity();
+	std::fill(cost.begin(), cost.begin()+(static_cast<std::size_t>(full)+1)*k, inf);
+	for (unsigned j = 0; j < k; j++) cost[(1u<<j)*k+j]=d[j+1];
+
+	//only customers in mask can be the last ones and only the others can be the next ones
+	for (unsigned mask = 1; mask < full; mask++) {
+		for (unsigned in = mask; in!=0; in&=in-1) {
+			const unsigned j=__builtin_ctz(in);
+			const double c=cost[mask*k+j];
+			const double* dj=&d[(j+1)*(k+1)+1];
+			for (unsigned out = full&~mask; out!=0; out&=out-1) {
+				const unsigned n=__builtin_ctz(out);
+				const std::size_t next=(mask|(1u<<n))*k+n;
+				const double nc=c+dj[n];
+				if(nc<cost[next]){
+					cost[next]=nc;
+					previous[next]=j;
 				}
 			}
+		}
+	}
 
-			routeStart=i+1;
+	//return to depot
+	unsigned last=0;
+	double best=inf;
+	for (unsigned j = 0; j < k; j++) {
+		const double c=cost[full*k+j]+d[j+1];
+		if(c<best){
+			best=c;
+			last=j;
 		}
+	}
 
+	//path from the end, customers are stored in original order of route
+	std::vector<const Vertex*> customers(solution.begin()+routeStart, solution.begin()+routeEnd);
+	unsigned mask=full;
+	for (unsigned s = routeEnd; s-- > routeStart; ) {
+		solution[s]=customers[last];
+		const unsigned p=previous[mask*k+last];
+		mask&=~(1u<<last);
+		last=p;
 	}
+}
+
+void ACO::twoOptRoute(std::vector<const Vertex*>& solution, const unsigned routeStart, const unsigned i) const{
+	//we can not swap depot, but we must calculate it in cost
+	//otherwise the route could become longer than maximum route time
+	double bestCost=solutionCost(solution, routeStart-1, i);
 
+
+  IMPROVED_START_AGAIN://until no improvement is made
+	for (unsigned x = routeStart; x < i; x++) {
+		for (unsigned y = x + 1; y < i; y++) {
+			std::vector<const Vertex*> newRoute;
+
+			//swap
+			//first part add in order (with depot)
+			for (unsigned s = routeStart-1; s < x; s++) {
+				newRoute.push_back(solution[s]);
+			}
+			//middle part add in reverse order (swapping)
+			for (unsigned s = y; s >= x; s--) {
+				newRoute.push_back(solution[s]);
+			}
+			//last part add in order (with depot)
+			for (unsigned s = y + 1; s <= i; s++) {
+				newRoute.push_back(solution[s]);
+			}
+
+			double actCost = solutionCost(newRoute);
+			if (actCost < bestCost) {
+				//change vehicle route
+				for (unsigned s = routeStart; s < i; s++)
+					solution[s] = newRoute[s - routeStart + 1];
+				bestCost = actCost;
+				goto IMPROVED_START_AGAIN;
+			}
+		}
+	}
 }
 
 /*** End of file: ACO.cpp ***/
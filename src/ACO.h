@@ -9,23 +9,27 @@
 #ifndef ACO_H_
 #define ACO_H_
 
-#include <set>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <random>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <unordered_map>
 #include "VRP.h"
+#include "RouteCache.h"
 
 
-class Vertex;
 /**
- * Representation of arc.
+ * Candidate for visiting from a vertex. Candidates of all vertices are stored in one array
+ * (compressed sparse row form, see ACO::candidatesBegin).
  */
-struct Arc{
-	double pheromone;	//! Actual pheromone
-	double visibility;  //! Pre calculated visibility.
-	double distance;	//! distance between vertices
-	std::set<Vertex*> v;	//! Vertices
-
+struct Candidate{
+	std::uint32_t vertex;	//! Index of candidate vertex.
+	std::uint32_t arc;	//! Index of arc data (pheromone, visibility, distance) in contiguous arrays of ACO (index of candidate in population based colony).
 };
 
 /**
@@ -34,26 +38,17 @@ struct Arc{
 class Vertex{
 public:
 	const Entity* c;			//! customer assigned to vertex
-	std::vector<Arc*> candidates;	//! candidates for visiting
+	double depotDistance=0;	//! Pre calculated distance to depot.
 
 	/**
-	 * Calculates distance to depot.
+	 * Distance to depot.
 	 *
 	 * @return Distance to depot.
-	 * @throw std::runtime_error	Vertex has not depot in candidates.
 	 */
 	double distToDepot() const{
-		for(auto a : candidates){
-			for(auto v: a->v){
-				if(v->c->type==EnityType::DEPOT){
-					//we can compare distance with time because we are assuming that
-					//vehicle velocity is one distance unit per one time unit
-					return a->distance;
-				}
-			}
-		}
-		//if we are here than something is rotten in the state of this program
-		throw std::runtime_error("Unexpected error when finding distance to depot from vertex.");
+		//we can compare distance with time because we are assuming that
+		//vehicle velocity is one distance unit per one time unit
+		return depotDistance;
 	}
 
 	/**
@@ -71,7 +66,235 @@ public:
 
 };
 
+/**
+ * Counters collected during solving.
+ */
+struct SolveStats{
+	unsigned long long constructions=0;	//! Number of constructed solutions.
+	unsigned long long localSearchSolutions=0;	//! Number of solutions improved by local search.
+	unsigned long long fullSweeps=0;	//! Iterations (batches in asynchronous colony) when local search was applied to all solutions.
+	unsigned long long nearestFallbacks=0;	//! Customers found in grid, because no candidate could be visited.
+	unsigned long long lateReturns=0;	//! Candidates rejected because vehicle could not return to depot in time after visiting them.
+	unsigned long long restarts=0;	//! Reinitializations of pheromone because of stagnation.
+	unsigned long long routeCacheHits=0;	//! Routes whose optimized order was found in cache.
+	unsigned long long routeCacheMisses=0;	//! Routes that were optimized with local search.
+	double localSearchTime=0;	//! Seconds spent in local search of routes that were not cached.
+	double localSearchTimeSaved=0;	//! Estimated seconds of local search saved by the route cache.
+
+	/**
+	 * Adds counters of other solving (e.g. of other cluster or thread).
+	 *
+	 * @param[in] o
+	 * 	Added counters.
+	 * @return This counters.
+	 */
+	SolveStats& operator+=(const SolveStats& o){
+		constructions+=o.constructions;
+		localSearchSolutions+=o.localSearchSolutions;
+		fullSweeps+=o.fullSweeps;
+		nearestFallbacks+=o.nearestFallbacks;
+		lateReturns+=o.lateReturns;
+		restarts+=o.restarts;
+		routeCacheHits+=o.routeCacheHits;
+		routeCacheMisses+=o.routeCacheMisses;
+		localSearchTime+=o.localSearchTime;
+		localSearchTimeSaved+=o.localSearchTimeSaved;
+		return *this;
+	}
+};
+
+/**
+ * Progress of solving that is reported to callback.
+ */
+struct SolveProgress{
+	unsigned iteration=0;	//! Actual iteration (from zero).
+	unsigned iterations=0;	//! Maximal number of iterations.
+	double bestCost=0;	//! Cost of the best solution so far (without drop time).
+	double elapsed=0;	//! Seconds from start of solving.
+	bool improved=false;	//! The best solution was improved since last report.
+	double branching=0;	//! Mean lambda-branching factor of customers. Zero when it is not tracked (see setRestartBranching).
+};
+
+/**
+ * Options of solving.
+ */
+struct SolveOptions{
+	unsigned iterations=0;	//! Maximal number of iterations. Zero means 2n (according to paper).
+	double timeLimit=0;	//! Maximal number of seconds. Zero means no limit. Checked once per iteration.
+	unsigned seed=0;	//! Seed of random generators of ants. Zero means random seed.
+
+	/**
+	 * Called after iteration, but at most once per progressInterval seconds.
+	 */
+	std::function<void(const SolveProgress&)> progress;
+	double progressInterval=1;	//! Minimal number of seconds between two progress reports.
+
+	const std::atomic<bool>* cancel=nullptr;	//! Solving stops when it is true. Checked once per iteration.
+};
+
+/**
+ * Result of solving.
+ */
+struct SolveResult{
+	double cost=std::numeric_limits<double>::infinity();	//! Cost of solution (without drop time).
+	std::vector<std::vector<unsigned>> routes;	//! Ids of customers for each vehicle route. Empty when solving was cancelled before the first solution.
+	unsigned iterations=0;	//! Number of finished iterations.
+	double elapsed=0;	//! Seconds of solving.
+	bool cancelled=false;	//! Solving was cancelled.
+	SolveStats stats;	//! Counters collected during solving.
+};
+
 class ACO;
+
+/**
+ * Uniform grid over customers for searching of the nearest customers.
+ * Customers of cell c are [cellOffsets[c], cellOffsets[c+1]) in customers.
+ */
+struct Grid{
+	double x0=0;	//! Minimal x coordinate of customers.
+	double y0=0;	//! Minimal y coordinate of customers.
+	double cellSize=1;	//! Width and height of one cell.
+	unsigned width=0;	//! Number of columns.
+	unsigned height=0;	//! Number of rows.
+	std::vector<std::uint32_t> cellOffsets;	//! Start of every cell in customers.
+	std::vector<std::uint32_t> customers;	//! Indices of customer vertices ordered by cells.
+	std::vector<std::uint32_t> cellOf;	//! Cell of every vertex (depot has cell of its nearest position).
+
+	/**
+	 * Column of x coordinate. Coordinates outside the grid are clamped.
+	 */
+	unsigned column(const double x) const {
+		return std::min<double>(width-1, std::max(0.0, (x-x0)/cellSize));
+	}
+
+	/**
+	 * Row of y coordinate. Coordinates outside the grid are clamped.
+	 */
+	unsigned row(const double y) const {
+		return std::min<double>(height-1, std::max(0.0, (y-y0)/cellSize));
+	}
+};
+
+/**
+ * Candidate lists of constructing ant without visited customers.
+ * Visited customer is removed from every list that contains it in constant time per list (swapped
+ * behind the end of the list), so ant does not scan visited candidates. Removed candidates are
+ * only behind the end, so lists are restored for next construction in linear time.
+ * Unvisited customers are also kept in cells of spatial grid (see Grid), for finding the nearest
+ * feasible customer when no candidate can be visited.
+ *
+ * Ants that are constructing one after another (in one thread) share the lists.
+ */
+class CandidateLists{
+public:
+	/**
+	 * Creates lists for actual problem of colony.
+	 *
+	 * @param[in] aco
+	 * 	Colony with candidate lists and grid.
+	 */
+	void init(const ACO& aco);
+
+	/**
+	 * Marks all customers as not visited.
+	 */
+	void reset();
+
+	/**
+	 * Marks customer as visited and removes it from all lists.
+	 *
+	 * @param[in] v
+	 * 	Index of customer vertex.
+	 */
+	void visit(const unsigned v);
+
+	bool isVisited(const unsigned v) const {
+		return visited[v];
+	}
+
+	unsigned getVisitedCount() const {
+		return visitedCount;
+	}
+
+	/**
+	 * First not visited candidate of given vertex.
+	 *
+	 * @param[in] v
+	 * 	Index of vertex.
+	 * @return Pointer to first candidate.
+	 */
+	const Candidate* begin(const unsigned v) const {
+		return entries.data()+offsets[v];
+	}
+
+	/**
+	 * End of not visited candidates of given vertex.
+	 *
+	 * @param[in] v
+	 * 	Index of vertex.
+	 * @return Pointer behind last not visited candidate.
+	 */
+	const Candidate* end(const unsigned v) const {
+		return entries.data()+offsets[v]+live[v];
+	}
+
+	/**
+	 * First not visited customer in cell of grid.
+	 */
+	const std::uint32_t* cellBegin(const unsigned c) const {
+		return cellCustomers.data()+grid->cellOffsets[c];
+	}
+
+	/**
+	 * End of not visited customers in cell of grid.
+	 */
+	const std::uint32_t* cellEnd(const unsigned c) const {
+		return cellCustomers.data()+grid->cellOffsets[c]+cellLive[c];
+	}
+
+	/**
+	 * Minimal demand of not visited customers in cell of grid.
+	 */
+	unsigned cellMinDemand(const unsigned c) const {
+		return cellMin[c];
+	}
+
+	unsigned long long fallbacks=0;	//! Customers found in grid, because no candidate could be visited.
+	unsigned long long lateReturns=0;	//! Candidates rejected because vehicle could not return to depot in time after visiting them.
+	std::vector<Candidate> use;	//! Buffer for candidates of roulette.
+	std::vector<double> choice;	//! Buffer for choice info of candidates of roulette.
+
+private:
+	const std::vector<Vertex>* vertices=nullptr;
+	const Grid* grid=nullptr;
+
+	//candidates of vertex u are [offsets[u], offsets[u]+live[u]), removed ones are behind them
+	std::vector<Candidate> entries;
+	std::vector<std::uint32_t> offsets;
+	std::vector<std::uint32_t> live;	//! Number of not visited candidates of every vertex.
+	std::vector<std::uint32_t> origin;	//! Original position of entry.
+	std::vector<std::uint32_t> where;	//! Actual position of entry with given original position.
+	std::vector<std::uint32_t> owner;	//! Vertex whose list contains entry with given original position.
+	//original positions of entries of customer v are [occurrenceOffsets[v], occurrenceOffsets[v+1])
+	std::vector<std::uint32_t> occurrenceOffsets;
+	std::vector<std::uint32_t> occurrences;
+
+	std::vector<char> visited;
+	unsigned visitedCount=0;
+
+	//not visited customers of cell c are [grid->cellOffsets[c], grid->cellOffsets[c]+cellLive[c])
+	std::vector<std::uint32_t> cellCustomers;
+	std::vector<std::uint32_t> cellLive;
+	std::vector<std::uint32_t> cellWhere;	//! Position of vertex in cellCustomers.
+	std::vector<unsigned> cellMin;	//! Minimal demand of not visited customers of cell.
+	std::vector<unsigned> initialCellMin;	//! Minimal demand of all customers of cell.
+
+	/**
+	 * Swaps two entries of candidate lists.
+	 */
+	void swapEntries(const std::uint32_t a, const std::uint32_t b);
+};
+
 /**
  * Representation of one ant.
  */
@@ -87,9 +310,22 @@ public:
 
 	/**
 	 * Generates solution for given problem.
+	 *
+	 * @param[in] lists
+	 * 	Candidate lists used for construction.
 	 * @throw std::runtime_error When maximum route time is too small.
 	 */
-	std::vector<const Vertex*> genSolution();
+	std::vector<const Vertex*> genSolution(CandidateLists& lists);
+
+	/**
+	 * Seeds random generator of ant.
+	 *
+	 * @param[in] s
+	 * 	Seed.
+	 */
+	void seed(const unsigned s){
+		randGen.seed(s);
+	}
 
 private:
 	const Vertex* initVertex;
@@ -99,20 +335,63 @@ private:
 	ACO* parentACO;
 	std::mt19937 randGen;
 	std::uniform_real_distribution<double> dist;
-
-	std::set<const Vertex*> tabu;	//! Already visited customers. We can use route but set is faster for finding elements in it
+	const double* choiceInfo=nullptr;	//! Choice info acquired for actual construction.
 
 	/**
 	 * Finds next vertex to visit.
 	 *
+	 * @param[in] lists
+	 * 	Candidate lists without visited customers.
+	 * @param[in] unconstrained
+	 * 	True means that capacity and route time are ignored and that all not visited customers
+	 * 	are used when no candidate can be visited (used for giant tour).
 	 * @return
 	 * 	Vertex to next visit. Nullptr in case of failure(no feasible vertex).
 	 * @throw std::runtime_error	Unexpected error when selecting next vertex.
 	 */
-	const Vertex* nextVisit();
+	const Vertex* nextVisit(CandidateLists& lists, const bool unconstrained=false);
+
+	/**
+	 * Finds not visited customer that can be visited on actual route, when no candidate can be visited
+	 * (candidates with zero choice info are preferred, see nextVisit).
+	 * Customer is selected with roulette from feasible customers that are at most FALLBACK_RADIUS times
+	 * farther than the nearest feasible customer. Customers that are farther from the actual vertex than
+	 * the depot are not selected and the search over grid stops at distance of depot, so the ant rather
+	 * returns to depot and starts new route than makes a long detour.
+	 *
+	 * @param[in] lists
+	 * 	Candidate lists without visited customers.
+	 * @return
+	 * 	Selected feasible customer. Nullptr when there is no one.
+	 */
+	const Vertex* nearestFeasible(CandidateLists& lists);
+
+	static constexpr double FALLBACK_RADIUS=1.5;	//! Relative distance of customers selected by nearestFeasible.
+
+	/**
+	 * Checks that customer can be visited on actual route.
+	 *
+	 * @param[in] v
+	 * 	Customer.
+	 * @param[in] distance
+	 * 	Distance from the last vertex of route.
+	 * @return True when capacity and route time are not exceeded.
+	 */
+	bool fits(const Vertex& v, const double distance) const;
+
+	/**
+	 * Generates giant tour over all customers (without depot) and splits it into vehicle routes.
+	 *
+	 * @param[in] lists
+	 * 	Candidate lists used for construction.
+	 * @return Solution with depots.
+	 * @throw std::runtime_error When maximum route time is too small.
+	 */
+	std::vector<const Vertex*> genGiantTour(CandidateLists& lists);
 
 	/**
 	 * Ant goes to depot.
+	 * @throw std::runtime_error When ant is already in depot (maximum route time is too small).
 	 */
 	void returnToDepot();
 };
@@ -127,6 +406,11 @@ private:
 class ACO {
 public:
 
+	/**
+	 * ACO initialization without problem. Problem must be loaded before solving.
+	 */
+	ACO();
+
 	/**
 	 * ACO initialization.
 	 *
@@ -135,12 +419,45 @@ public:
 	 */
 	ACO(VRP& v);
 
+	/**
+	 * Loads new problem. Parameters of the colony are kept and allocated
+	 * buffers are reused, so one solver can serve many problems. Arcs and ants are created
+	 * by the first solving (see solve), so solving with savings only (see solveSavings)
+	 * does not allocate them.
+	 *
+	 * @param[in] v
+	 * 	VRP problem.
+	 */
+	void load(const VRP& v);
+
 	/**
 	 * Solves VRP for given problem.
 	 * @param[in] iterations
 	 * 	Number of iterations.
+	 * @return Result of solving.
 	 */
-	void solve(const unsigned iterations);
+	SolveResult solve(const unsigned iterations);
+
+	/**
+	 * Solves VRP with parallel Clarke-Wright savings (see savingsSolution) and local search of routes.
+	 * It takes milliseconds, so it can be used when there is no time for colony. Arcs and ants
+	 * are not created, so memory is linear in number of customers.
+	 *
+	 * @return Result of solving with zero iterations.
+	 * @throw std::runtime_error When maximum route time or capacity is too small.
+	 */
+	SolveResult solveSavings();
+
+	/**
+	 * Solves VRP for given problem.
+	 * Does not print anything, progress is reported with callback.
+	 *
+	 * @param[in] options
+	 * 	Options of solving.
+	 * @return Result of solving.
+	 * @throw std::runtime_error When there are too many arcs for their indices (see MAX_ARCS).
+	 */
+	SolveResult solve(const SolveOptions& options);
 
 	double getAlfa() const {
 		return alfa;
@@ -158,12 +475,26 @@ public:
 		this->ants = ants;
 	}
 
-	const std::vector<Arc>& getArcs() const {
-		return arcs;
+	/**
+	 * First candidate for visiting from given vertex.
+	 *
+	 * @param[in] v
+	 * 	Index of vertex.
+	 * @return Pointer to first candidate.
+	 */
+	const Candidate* candidatesBegin(const unsigned v) const {
+		return candidates.data()+candidateOffsets[v];
 	}
 
-	void setArcs(const std::vector<Arc>& arcs) {
-		this->arcs = arcs;
+	/**
+	 * End of candidates for visiting from given vertex.
+	 *
+	 * @param[in] v
+	 * 	Index of vertex.
+	 * @return Pointer behind last candidate.
+	 */
+	const Candidate* candidatesEnd(const unsigned v) const {
+		return candidates.data()+candidateOffsets[v+1];
 	}
 
 	double getBeta() const {
@@ -172,7 +503,7 @@ public:
 
 	void setBeta(double beta = 5) {
 		this->beta = beta;
-		arcCreate();
+		arcsCreated=false;
 	}
 
 	unsigned getElitAnts() const {
@@ -183,13 +514,167 @@ public:
 		this->elitAnts = elitAnts;
 	}
 
+	unsigned getLocalSearchAnts() const {
+		return localSearchAnts;
+	}
+
+	/**
+	 * Sets number of solutions improved by local search in one iteration.
+	 * Solutions are ranked by construction cost and only the best ones are improved.
+	 *
+	 * @param[in] localSearchAnts
+	 * 	Number of improved solutions. Zero means all.
+	 */
+	void setLocalSearchAnts(unsigned localSearchAnts = 0) {
+		this->localSearchAnts = localSearchAnts;
+	}
+
+	double getFullSweepProbability() const {
+		return fullSweepProbability;
+	}
+
+	/**
+	 * Sets probability that local search is applied to all solutions of iteration.
+	 *
+	 * @param[in] fullSweepProbability
+	 * 	Probability in interval [0,1].
+	 */
+	void setFullSweepProbability(double fullSweepProbability = 0) {
+		this->fullSweepProbability = fullSweepProbability;
+	}
+
+	unsigned getStagnationSweep() const {
+		return stagnationSweep;
+	}
+
+	/**
+	 * Local search is applied to all solutions, when the best solution was not improved
+	 * for given number of iterations.
+	 *
+	 * @param[in] stagnationSweep
+	 * 	Number of iterations without improvement. Zero disables it.
+	 */
+	void setStagnationSweep(unsigned stagnationSweep = 0) {
+		this->stagnationSweep = stagnationSweep;
+	}
+
+	unsigned getAsyncWorkers() const {
+		return asyncWorkers;
+	}
+
+	/**
+	 * Selects asynchronous colony. Every worker thread owns part of the ants and
+	 * constructs, improves and deposits their solutions without waiting for the others.
+	 * Evaporation is done once per epoch (as many constructions as ants) and iterations
+	 * of solving are counted in epochs. Results are not reproducible with seed.
+	 *
+	 * @param[in] asyncWorkers
+	 * 	Number of worker threads. Zero means synchronous colony.
+	 */
+	void setAsyncWorkers(unsigned asyncWorkers = 0) {
+		this->asyncWorkers = asyncWorkers;
+	}
+
+	unsigned getExactRouteSize() const {
+		return exactRouteSize;
+	}
+
+	/**
+	 * Sets maximal number of customers of route that is optimized exactly (see exactRoute).
+	 * Longer routes are optimized with 2-opt.
+	 *
+	 * @param[in] exactRouteSize
+	 * 	Number of customers, at most MAX_EXACT_ROUTE_SIZE. Zero means that 2-opt is used for all routes.
+	 */
+	void setExactRouteSize(unsigned exactRouteSize = 9) {
+		this->exactRouteSize = std::min(exactRouteSize, MAX_EXACT_ROUTE_SIZE);
+	}
+
+	static constexpr unsigned MAX_EXACT_ROUTE_SIZE=16;	//! Table for 16 customers has 2^16*16 items.
+
+	unsigned getPopulation() const {
+		return population;
+	}
+
+	/**
+	 * Selects population based colony (P-ACO). Pheromone is not stored for all arcs, it is derived
+	 * from number of archived solutions that are using the arc (see populationPheromone) and there is
+	 * no evaporation. Archive has the last population iteration best solutions (first in first out)
+	 * and the best solution so far. Arc data are stored for candidates only and customer has at most
+	 * PACO_CANDIDATES of them (found with grid), so memory is linear and not n^2. Asynchronous colony
+	 * (setAsyncWorkers) is not used in this mode.
+	 *
+	 * @param[in] population
+	 * 	Number of archived iteration best solutions. Zero means colony with pheromone of all arcs.
+	 */
+	void setPopulation(unsigned population = 0) {
+		const bool rebuild=(population>0)!=(this->population>0);
+		this->population=population;
+		if(rebuild) arcsCreated=false;
+	}
+
+	bool getSavingsStart() const {
+		return savingsStart;
+	}
+
+	/**
+	 * Selects start of colony. Savings solution (see solveSavings) is the first best solution so far
+	 * and initial pheromone is scaled by its cost: elitAnts/((1-ro)*cost). Otherwise initial pheromone is 100.
+	 *
+	 * @param[in] savingsStart
+	 * 	True means start from savings solution.
+	 */
+	void setSavingsStart(bool savingsStart = false) {
+		this->savingsStart = savingsStart;
+	}
+
+	double getRestartBranching() const {
+		return restartBranching;
+	}
+
+	/**
+	 * Sets detection of stagnation. Colony tracks lambda-branching factor of every customer (number of
+	 * its candidates with pheromone at least tauMin+BRANCHING_LAMBDA*(tauMax-tauMin) of its candidates).
+	 * When mean of them drops below given number, colony converged and pheromone is reinitialized
+	 * (the best solution so far is kept). Factors are recalculated only for vertices of deposited arcs,
+	 * because evaporation does not change them. Asynchronous colony does not track it. Population based
+	 * colony tests it only when its archive is full.
+	 *
+	 * @param[in] restartBranching
+	 * 	Mean branching factor of stagnation. Zero disables it.
+	 */
+	void setRestartBranching(double restartBranching = 0) {
+		this->restartBranching = restartBranching;
+	}
+
+	static constexpr double BRANCHING_LAMBDA=0.05;	//! Lambda of branching factor.
+
+	static constexpr double PACO_MAX_PHEROMONE=5;	//! Pheromone of arc used by all archived solutions. Initial one is 1.
+	static constexpr unsigned PACO_CANDIDATES=30;	//! Maximum number of candidates of customer in population based colony.
+
+	bool getGiantTour() const {
+		return giantTour;
+	}
+
+	/**
+	 * Selects construction mode.
+	 *
+	 * @param[in] giantTour
+	 * 	True means that ants are creating one tour over all customers, that is
+	 * 	optimally split to vehicle routes (see split). False means that ants are returning
+	 * 	to depot when there is no feasible customer.
+	 */
+	void setGiantTour(bool giantTour = false) {
+		this->giantTour = giantTour;
+	}
+
 	double getF() const {
 		return f;
 	}
 
 	void setF(double f = 2) {
 		this->f = f;
-		arcCreate();
+		arcsCreated=false;
 	}
 
 	double getG() const {
@@ -198,7 +683,7 @@ public:
 
 	void setG(double g = 2) {
 		this->g = g;
-		arcCreate();
+		arcsCreated=false;
 	}
 
 	unsigned getNumOfCandidates() const {
@@ -207,7 +692,7 @@ public:
 
 	void setNumOfCandidates(unsigned numOfCandidates) {
 		this->numOfCandidates = numOfCandidates;
-		arcCreate();
+		arcsCreated=false;
 	}
 
 	double getRo() const {
@@ -230,6 +715,104 @@ public:
 		return vrp;
 	}
 
+	/**
+	 * Stored pheromone. Actual pheromone is stored pheromone multiplied by pheromone scale.
+	 *
+	 * @return Stored pheromone of all arcs.
+	 */
+	const std::vector<double>& getPheromone() const {
+		return pheromone;
+	}
+
+	double getPheromoneScale() const {
+		return pheromoneScale.load(std::memory_order_relaxed);
+	}
+
+	const std::vector<double>& getVisibility() const {
+		return visibility;
+	}
+
+	const std::vector<double>& getDistance() const {
+		return distance;
+	}
+
+	/**
+	 * Choice info of arcs (pheromone^alfa*visibility). Asynchronous colony publishes renormalized
+	 * choice info in other buffer, so constructing ants must use acquireChoiceInfo.
+	 *
+	 * @return Choice info of arcs (see edgeIndex).
+	 */
+	const double* getChoiceInfo() const {
+		return choiceData.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Choice info for construction of one solution. In asynchronous colony renormalization
+	 * does not write to returned buffer until it is released with releaseChoiceInfo.
+	 *
+	 * @param[out] slot
+	 * 	Buffer of choice info that must be released.
+	 * @return Choice info of arcs (see edgeIndex).
+	 */
+	const double* acquireChoiceInfo(unsigned& slot);
+
+	/**
+	 * Releases choice info acquired with acquireChoiceInfo.
+	 *
+	 * @param[in] slot
+	 * 	Buffer of choice info.
+	 */
+	void releaseChoiceInfo(const unsigned slot);
+
+	const Grid& getGrid() const {
+		return grid;
+	}
+
+	/**
+	 * Index of arc data in contiguous arrays (pheromone, visibility, distance, choice info).
+	 * Population based colony has no arrays of all arcs (see arcDistance and arcChoice).
+	 * Arcs are stored in order (0,1), (0,2), ..., (0,n-1), (1,2), ... There are at most MAX_ARCS
+	 * of them, so the index fits to unsigned.
+	 *
+	 * @param[in] i
+	 * 	Index of first vertex.
+	 * @param[in] j
+	 * 	Index of second vertex. Must be different from i.
+	 * @return Index of arc.
+	 */
+	unsigned edgeIndex(unsigned i, unsigned j) const {
+		if(i>j) std::swap(i,j);
+		return i*(2*vertices.size()-i-1)/2+j-i-1;
+	}
+
+	/**
+	 * Distance of any arc (also the one that is not candidate). It is calculated when there is no array
+	 * of all arcs (population based colony or arcs that are not created yet).
+	 *
+	 * @param[in] i
+	 * 	Index of first vertex.
+	 * @param[in] j
+	 * 	Index of second vertex. Must be different from i.
+	 * @return Distance between vertices.
+	 */
+	double arcDistance(const unsigned i, const unsigned j) const {
+		return population>0 || !arcsCreated ? vertices[i].distToVertex(vertices[j]) : distance[edgeIndex(i, j)];
+	}
+
+	/**
+	 * Choice info of any arc (also the one that is not candidate).
+	 * Population based colony calculates it for arcs that are not candidates.
+	 *
+	 * @param[in] i
+	 * 	Index of first vertex.
+	 * @param[in] j
+	 * 	Index of second vertex. Must be different from i.
+	 * @param[in] choice
+	 * 	Choice info of arcs acquired by ant (see acquireChoiceInfo).
+	 * @return pheromone^alfa*visibility
+	 */
+	double arcChoice(const unsigned i, const unsigned j, const double* choice) const;
+
 	/**
 	 * Calculates cost of route.
 	 *
@@ -270,6 +853,32 @@ public:
 	}
 
 
+	std::size_t getRouteCacheSize() const {
+		return routeCache.getSlots();
+	}
+
+	/**
+	 * Sets maximal number of routes in cache of optimized routes.
+	 *
+	 * @param[in] size
+	 * 	Maximal number of routes. Zero disables the cache.
+	 */
+	void setRouteCacheSize(std::size_t size = 4096) {
+		routeCache.resize(size);
+	}
+
+	/**
+	 * Splits giant tour into vehicle routes with minimal cost (Prins split).
+	 * Uses monotone queue, so it works in linear time.
+	 *
+	 * @param[in] tour
+	 * 	Order of all customers (without depot).
+	 * @return
+	 * 	Solution with depots.
+	 * @throw std::runtime_error	Some customer can not be visited because of capacity or route time.
+	 */
+	std::vector<const Vertex*> split(const std::vector<const Vertex*>& tour) const;
+
 	/**
 	 * Tries to optimize solution with two opt heuristic.
 	 *
@@ -287,6 +896,15 @@ public:
 		return bestSoFar;
 	}
 
+	/**
+	 * Get counters of last solving.
+	 *
+	 * @return Counters
+	 */
+	const SolveStats& getStats() const {
+		return stats;
+	}
+
 private:
 	VRP vrp;
 
@@ -298,13 +916,78 @@ private:
 	double g=2;	//! Number greater than one. Parameter used for visibility calculation.
 	unsigned elitAnts=6; //!Number of selected elitist ants.
 	unsigned numOfCandidates; //!Maximum number of candidates. (Without the depot)
+	bool giantTour=false;	//! Ants are creating giant tour that is split to vehicle routes.
+	unsigned localSearchAnts=0;	//! Number of the best constructed solutions improved by local search. Zero means all.
+	double fullSweepProbability=0;	//! Probability that all solutions of iteration are improved.
+	unsigned stagnationSweep=0;	//! All solutions are improved after this number of iterations without improvement.
+	unsigned asyncWorkers=0;	//! Number of threads of asynchronous colony. Zero means synchronous colony.
+	unsigned exactRouteSize=9;	//! Routes with at most this number of customers are optimized exactly.
+	unsigned population=0;	//! Archived iteration best solutions of population based colony. Zero means pheromone of all arcs.
+	double restartBranching=0;	//! Pheromone is reinitialized when mean branching factor drops below it. Zero disables it.
+	bool savingsStart=false;	//! Colony starts from savings solution.
+	double initialPheromone=100;	//! Pheromone of all arcs at start of solving.
+
+	//! Arcs and candidates are indexed with 32 bits, so colony with data of all arcs has at most 92682 vertices.
+	static constexpr std::size_t MAX_ARCS=std::numeric_limits<std::uint32_t>::max();
+	static constexpr unsigned SAVINGS_NEIGHBOURS=40;	//! Savings are calculated with this number of the nearest candidates.
 
 
 	std::vector<Vertex> vertices;	//First vertex in vector is depot
-	std::vector<Arc> arcs;
 	std::vector<Ant> ants;
 
+	//candidates for visiting, vertex i has candidates [candidateOffsets[i], candidateOffsets[i+1])
+	std::vector<std::uint32_t> candidateOffsets;
+	std::vector<Candidate> candidates;
+	bool arcsCreated=false;	//! Arcs and candidates are created for loaded problem and actual parameters.
+	std::vector<CandidateLists> candidateLists;	//! Lists of constructing ants, one for every thread.
+	Grid grid;	//! Grid over customers.
+
+	//arc data in contiguous arrays (see edgeIndex), population based colony has data of candidates only
+	std::vector<double> pheromone;	//! Pheromone divided by pheromoneScale.
+	std::vector<double> visibility;	//! Pre calculated visibility (powered by beta).
+	std::vector<double> distance;	//! Distance between vertices.
+	std::vector<double> choiceInfo;	//! pheromone^alfa*visibility, refreshed after every pheromone update.
+
+	//Evaporation multiplies all pheromones by the same number, so it is done lazily on one global factor.
+	//It does not change the probabilities of selection (they are normalized), so choice info is
+	//calculated from stored pheromone and only deposited arcs must be refreshed.
+	std::atomic<double> pheromoneScale;	//! Actual pheromone of arc is pheromoneScale*pheromone[arc]. Atomic for asynchronous colony.
+	std::vector<unsigned> touchedArcs;	//! Arcs with deposited pheromone in actual iteration.
+
+	static constexpr double MIN_SCALE_POWER=1e-100; //! Renormalize pheromone when pheromoneScale^alfa is smaller.
+
 	std::pair<double, std::vector<const Vertex*>> bestSoFar; //! so far the best solution searched
+	SolveStats stats;	//! counters of last solving
+
+	mutable RouteCache routeCache;	//! already optimized routes
+	mutable std::atomic<unsigned long long> localSearchNanos;	//! time spent in local search of not cached routes
+
+	//Asynchronous colony deposits without locks (compare and swap). Only renormalization of pheromone
+	//needs all arcs, so it waits until running deposits end and new ones wait for it.
+	//Renormalized choice info is calculated in the other of two buffers and published at once.
+	//Constructing ants are counted for buffer they read, so buffer is reused when no ant reads it.
+	bool concurrent=false;	//! Pheromone is deposited by more threads at once.
+	std::atomic<unsigned> depositors;	//! Threads that are depositing pheromone or evaporating.
+	std::atomic<bool> renormalizing;	//! Renormalization is running.
+	std::vector<double> choiceScratch;	//! Choice info calculated during concurrent renormalization.
+	std::atomic<const double*> choiceData;	//! Published choice info (data of choiceInfo) that is read by ants.
+	double* choiceBuffers[2]={nullptr, nullptr};	//! Both buffers of choice info in asynchronous colony.
+	std::atomic<unsigned> choiceSlot;	//! Index of published buffer in choiceBuffers.
+	std::atomic<unsigned> choiceReaders[2];	//! Number of constructing ants reading the buffer.
+
+	//Population based colony derives pheromone from number of archived solutions that are using the arc.
+	//Only arcs of archived solutions have their counts, so the memory is proportional to population*n.
+	std::deque<std::vector<const Vertex*>> archive;	//! Archived iteration best solutions, the oldest is first.
+	std::vector<const Vertex*> archivedBest;	//! The best solution so far that is counted in edgeCounts.
+	std::unordered_map<std::uint64_t, std::uint32_t> edgeCounts;	//! Number of uses of edge in archive (see edgeKey).
+	double visibilityShift=0;	//! Savings are shifted by it and powered by beta. Zero means that they are not.
+
+	//Branching factors depend on ratios of pheromones only, so lazy evaporation does not change them.
+	//They are recalculated for vertices of deposited arcs after pheromone update.
+	std::vector<std::uint32_t> branching;	//! Branching factor of every vertex. Empty when it is not tracked.
+	unsigned long long branchingSum=0;	//! Sum of branching factors of customers.
+	std::vector<char> touchedVertex;	//! Vertex has deposited arcs in actual iteration.
+	std::vector<unsigned> touchedVertices;	//! Vertices with deposited arcs in actual iteration.
 
 
 	/**
@@ -315,27 +998,298 @@ private:
 	 * @param[in] u
 	 * 	Other vertex for arc searching.
 	 * @return
-	 * 	Corepsonding arc. Nullptr when arc with given vertex is not in candidates.
-	 */
-	Arc* selectArc(const Vertex& v, const Vertex& u){
-
-		for(Arc& a: arcs){
-			bool one=false;
-			for(const Vertex* aV: a.v){
-				if(aV->c->id==v.c->id || aV->c->id==u.c->id){
-					if(one) return &a;
-					one=true;
-				}
-			}
+	 * 	Index of corresponding arc.
+	 */
+	unsigned selectArc(const Vertex& v, const Vertex& u) const{
+		//vertex index is the same as id of its entity
+		return edgeIndex(v.c->id, u.c->id);
+	}
+
+	/**
+	 * Creates solution with parallel Clarke-Wright savings algorithm. Every customer starts
+	 * on its own route and routes are joined by their end customers i, j in order of decreasing savings
+	 * d0i+d0j-dij (max heap), while capacity and route time allow it. Savings are calculated
+	 * for SAVINGS_NEIGHBOURS nearest customers of every customer only. They are found with grid,
+	 * so arcs are not needed.
+	 *
+	 * @return Solution with depots.
+	 * @throw std::runtime_error When maximum route time is too small.
+	 */
+	std::vector<const Vertex*> savingsSolution() const;
+
+	/**
+	 * Finds the nearest customers of vertex with grid (see Grid). Cells are searched in rings
+	 * around cell of the vertex until no closer customer can be found.
+	 *
+	 * @param[in] v
+	 * 	Index of vertex.
+	 * @param[in] k
+	 * 	Number of the nearest customers.
+	 * @param[out] nearest
+	 * 	Indices of at most k nearest customers (without v) ordered by distance.
+	 */
+	void nearestCustomers(const unsigned v, const unsigned k, std::vector<std::uint32_t>& nearest) const;
+
+	/**
+	 * Optimizes one vehicle route. Uses cache of already optimized routes.
+	 *
+	 * @param[in|out] solution
+	 * 	Solution with route for optimization.
+	 * @param[in] routeStart
+	 * 	Index of first customer of route.
+	 * @param[in] routeEnd
+	 * 	Index of depot at the end of route.
+	 */
+	void improveRoute(std::vector<const Vertex*>& solution, const unsigned routeStart, const unsigned routeEnd) const;
+
+	/**
+	 * Finds optimal order of customers of one vehicle route with dynamic programming over subsets
+	 * (Held-Karp). Time is O(2^k*k^2) for k customers, so it is used for short routes only.
+	 *
+	 * @param[in|out] solution
+	 * 	Solution with route for optimization.
+	 * @param[in] routeStart
+	 * 	Index of first customer of route.
+	 * @param[in] routeEnd
+	 * 	Index of depot at the end of route. Route must have at most exactRouteSize customers.
+	 */
+	void exactRoute(std::vector<const Vertex*>& solution, const unsigned routeStart, const unsigned routeEnd) const;
+
+	/**
+	 * Optimizes one vehicle route with two opt heuristic.
+	 *
+	 * @param[in|out] solution
+	 * 	Solution with route for optimization.
+	 * @param[in] routeStart
+	 * 	Index of first customer of route.
+	 * @param[in] routeEnd
+	 * 	Index of depot at the end of route.
+	 */
+	void twoOptRoute(std::vector<const Vertex*>& solution, const unsigned routeStart, const unsigned routeEnd) const;
+
+	/**
+	 * Recalculates choice info for all arcs.
+	 */
+	void refreshChoiceInfo();
+
+	/**
+	 * Sets initial pheromone on all arcs. The best solution so far (when there is one) stays in archive
+	 * of population based colony. Recalculates all branching factors when they are tracked.
+	 */
+	void resetPheromone();
+
+	/**
+	 * Marks vertex of deposited arc for recalculation of its branching factor.
+	 *
+	 * @param[in] v
+	 * 	Index of vertex.
+	 */
+	void touchVertex(const unsigned v){
+		if(!branching.empty() && !touchedVertex[v]){
+			touchedVertex[v]=1;
+			touchedVertices.push_back(v);
 		}
+	}
+
+	/**
+	 * Recalculates branching factors of touched vertices.
+	 */
+	void updateBranching();
+
+	/**
+	 * Calculates lambda-branching factor of vertex over its candidates.
+	 *
+	 * @param[in] v
+	 * 	Index of vertex.
+	 * @return Number of candidates with pheromone at least tauMin+BRANCHING_LAMBDA*(tauMax-tauMin).
+	 */
+	std::uint32_t vertexBranching(const unsigned v) const;
 
-		return nullptr;
+	/**
+	 * Mean branching factor of customers.
+	 */
+	double meanBranching() const {
+		return vertices.size()>1 ? static_cast<double>(branchingSum)/(vertices.size()-1) : 0;
 	}
 
 	/**
-	 * Creates arcs.
+	 * Evaporates pheromone on all arcs in constant time (just changes pheromoneScale).
+	 */
+	void evaporate();
+
+	/**
+	 * Multiplies stored pheromones with pheromoneScale and sets the scale back to one.
+	 * Prevents overflow of stored pheromone and choice info.
+	 */
+	void renormalizePheromone();
+
+	/**
+	 * Adds pheromone to arc.
+	 *
+	 * @param[in] a
+	 * 	Index of arc.
+	 * @param[in] delta
+	 * 	Actual (not scaled) amount of pheromone.
+	 */
+	void deposit(const unsigned a, const double delta);
+
+	/**
+	 * Adds number to double with compare and swap.
+	 *
+	 * @param[in|out] target
+	 * 	Number that is increased.
+	 * @param[in] delta
+	 * 	Added number.
+	 * @return New value.
+	 */
+	static double atomicAdd(double& target, const double delta);
+
+	/**
+	 * Starts deposit in asynchronous colony. Waits when renormalization is running.
+	 */
+	void enterDeposit();
+
+	/**
+	 * Ends deposit in asynchronous colony.
+	 */
+	void leaveDeposit();
+
+	/**
+	 * Evaporates pheromone in asynchronous colony. Renormalizes pheromone when it is needed.
+	 */
+	void evaporateConcurrent();
+
+	/**
+	 * Improves solutions with local search.
+	 *
+	 * @param[in|out] solutions
+	 * 	Solutions for improvement.
+	 * @param[in|out] sorted
+	 * 	Cost and index of every solution. Costs of improved solutions are updated.
+	 * @param[in] all
+	 * 	True means that all solutions are improved, otherwise only localSearchAnts best of them.
+	 * @return Number of improved solutions.
+	 */
+	unsigned improveSolutions(std::vector<std::vector<const Vertex*>>& solutions,
+			std::vector<std::pair<double,unsigned>>& sorted, const bool all) const;
+
+	/**
+	 * Deposits pheromone of elite solutions (rank based) and of the best solution so far.
+	 *
+	 * @param[in] solutions
+	 * 	Constructed solutions.
+	 * @param[in] elite
+	 * 	Cost and index of elite solutions sorted by cost.
+	 * @param[in] best
+	 * 	The best solution so far.
+	 * @param[in] share
+	 * 	Multiplies all deposits. Part of the colony that constructed the solutions.
+	 */
+	void depositSolutions(const std::vector<std::vector<const Vertex*>>& solutions,
+			const std::vector<std::pair<double,unsigned>>& elite,
+			const std::pair<double, std::vector<const Vertex*>>& best, const double share);
+
+	/**
+	 * Key of undirected edge in edgeCounts.
+	 */
+	static std::uint64_t edgeKey(const std::uint32_t i, const std::uint32_t j) {
+		return i<j ? (static_cast<std::uint64_t>(i)<<32)|j : (static_cast<std::uint64_t>(j)<<32)|i;
+	}
+
+	/**
+	 * Pheromone of arc in population based colony.
+	 *
+	 * @param[in] count
+	 * 	Number of uses of arc in archive.
+	 * @return Pheromone from 1 (unused arc) to PACO_MAX_PHEROMONE (arc of all archived solutions).
+	 */
+	double populationPheromone(const std::uint32_t count) const {
+		return 1+count*(PACO_MAX_PHEROMONE-1)/(population+1);
+	}
+
+	/**
+	 * Finds candidate j of vertex i in population based colony, where candidates are sorted by vertices.
+	 *
+	 * @param[in] i
+	 * 	Index of vertex.
+	 * @param[in] j
+	 * 	Index of candidate vertex.
+	 * @return Candidate or nullptr when j is not candidate of i.
+	 */
+	const Candidate* findCandidate(const unsigned i, const unsigned j) const;
+
+	/**
+	 * Calculates visibility of arc in population based colony.
+	 *
+	 * @param[in] i
+	 * 	Index of first vertex.
+	 * @param[in] j
+	 * 	Index of second vertex.
+	 * @return Visibility (powered by beta).
+	 */
+	double arcVisibility(const unsigned i, const unsigned j) const;
+
+	/**
+	 * Adds arcs of solution to archive counts or removes them from it and refreshes choice info of
+	 * changed candidates. Time is linear to solution length.
+	 *
+	 * @param[in] solution
+	 * 	Solution with depots.
+	 * @param[in] add
+	 * 	True adds solution, false removes it.
+	 */
+	void countSolution(const std::vector<const Vertex*>& solution, const bool add);
+
+	/**
+	 * Puts iteration best solution into archive of population based colony and removes the oldest one,
+	 * when archive is full. Replaces archived best solution so far, when it was changed.
+	 *
+	 * @param[in] iterationBest
+	 * 	The best solution of iteration.
+	 * @param[in] newBest
+	 * 	The best solution so far was changed in this iteration.
+	 */
+	void updateArchive(const std::vector<const Vertex*>& iterationBest, const bool newBest);
+
+	/**
+	 * Solving with asynchronous colony (see setAsyncWorkers).
+	 *
+	 * @param[in] options
+	 * 	Options of solving.
+	 * @param[in] iterations
+	 * 	Maximal number of epochs.
+	 * @param[out] cancelled
+	 * 	Solving was cancelled.
+	 * @return Number of finished epochs.
+	 * @throw std::runtime_error When maximum route time is too small.
+	 */
+	unsigned solveAsync(const SolveOptions& options, const unsigned iterations, bool& cancelled);
+
+	/**
+	 * Fills result (cost, routes and statistics) with the best solution so far.
+	 *
+	 * @param[out] result
+	 * 	Result of solving.
+	 */
+	void finishSolve(SolveResult& result);
+
+	/**
+	 * Creates grid over customers.
+	 */
+	void gridCreate();
+
+	/**
+	 * Creates arcs and candidates of loaded problem.
 	 */
 	void arcCreate();
+
+	/**
+	 * Calculates shift of visibility for population based colony without storing of all arcs.
+	 *
+	 * @param[in] d0
+	 * 	Distances of vertices to depot.
+	 */
+	void visibilityShiftCreate(const std::vector<double>& d0);
 };
 
 #endif /* ACO_H_ */
@@ -0,0 +1,384 @@
+/**
+ * Project: VRPAntColony
+ * @file Decomposition.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief  Source file of cluster first decomposition of big vehicle routing problems.
+ */
+
+#include "Decomposition.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+
+Decomposition::Decomposition(const VRP& v) :vrp(v) {}
+
+double Decomposition::routeTime(const std::vector<unsigned>& route) const{
+	double time=static_cast<double>(vrp.getDropTime())*route.size();
+	unsigned previous=0;
+	for(unsigned c : route){
+		time+=VRP::distance(entity(previous), entity(c));
+		previous=c;
+	}
+	return time+VRP::distance(entity(previous), vrp.getDepot());
+}
+
+std::vector<std::vector<unsigned>> Decomposition::partition(const std::vector<Site>& sites, const unsigned round,
+		const unsigned seed) const{
+	if(clustering==Clustering::KMEANS) return kmeans(sites, seed);
+	return sweep(sites, round);
+}
+
+std::vector<std::vector<unsigned>> Decomposition::sweep(const std::vector<Site>& sites, const unsigned round) const{
+	const Point& depot=vrp.getDepot().p;
+	std::vector<std::pair<double, unsigned>> angles;	//angle, site index
+	angles.reserve(sites.size());
+	for (unsigned i = 0; i < sites.size(); i++) {
+		angles.push_back(std::make_pair(std::atan2(sites[i].y-depot.y, sites[i].x-depot.x), i));
+	}
+	std::sort(angles.begin(), angles.end());
+
+	//every odd round starts in the middle of a cluster of previous round, so the borders are moved
+	unsigned start=0;
+	if(round%2==1){
+		for(unsigned skipped=0; start<angles.size() && skipped<clusterSize/2; start++){
+			skipped+=sites[angles[start].second].weight;
+		}
+		if(start==angles.size()) start=0;
+	}
+
+	std::vector<std::vector<unsigned>> clusters(1);
+	unsigned size=0;
+	for (unsigned k = 0; k < angles.size(); k++) {
+		const unsigned i=angles[(start+k)%angles.size()].second;
+		if(size>=clusterSize){
+			clusters.push_back(std::vector<unsigned>());
+			size=0;
+		}
+		clusters.back().push_back(i);
+		size+=sites[i].weight;
+	}
+
+	//small rest is joined to its neighbour
+	if(clusters.size()>1 && 2*size<clusterSize){
+		clusters[clusters.size()-2].insert(clusters[clusters.size()-2].end(), clusters.back().begin(), clusters.back().end());
+		clusters.pop_back();
+	}
+	return clusters;
+}
+
+std::vector<std::vector<unsigned>> Decomposition::kmeans(const std::vector<Site>& sites, const unsigned seed) const{
+	unsigned long long total=0;
+	for(const Site& s : sites) total+=s.weight;
+	const unsigned k=std::max<unsigned long long>(1, std::min<unsigned long long>(sites.size(),
+			(total+clusterSize-1)/std::max(clusterSize, 1u)));
+
+	//initial centers are random sites
+	std::mt19937 gen(seed);
+	std::vector<unsigned> order(sites.size());
+	for (unsigned i = 0; i < order.size(); i++) order[i]=i;
+	std::shuffle(order.begin(), order.end(), gen);
+
+	std::vector<Site> centers;
+	for (unsigned c = 0; c < k; c++) centers.push_back(sites[order[c]]);
+
+	std::vector<unsigned> assignment(sites.size(), 0);
+	for (unsigned it = 0; it < KMEANS_ITERATIONS; it++) {
+		bool changed=false;
+		for (unsigned i = 0; i < sites.size(); i++) {
+			unsigned nearest=0;
+			double nearestDist=std::numeric_limits<double>::infinity();
+			for (unsigned c = 0; c < k; c++) {
+				const double dx=sites[i].x-centers[c].x, dy=sites[i].y-centers[c].y;
+				if(dx*dx+dy*dy<nearestDist){
+					nearestDist=dx*dx+dy*dy;
+					nearest=c;
+				}
+			}
+			if(it==0 || assignment[i]!=nearest) changed=true;
+			assignment[i]=nearest;
+		}
+		if(!changed) break;
+
+		//centers are weighted averages (route with more customers has bigger weight)
+		std::vector<double> sumX(k, 0), sumY(k, 0), weight(k, 0);
+		for (unsigned i = 0; i < sites.size(); i++) {
+			sumX[assignment[i]]+=sites[i].x*sites[i].weight;
+			sumY[assignment[i]]+=sites[i].y*sites[i].weight;
+			weight[assignment[i]]+=sites[i].weight;
+		}
+		for (unsigned c = 0; c < k; c++) {
+			if(weight[c]>0){
+				centers[c].x=sumX[c]/weight[c];
+				centers[c].y=sumY[c]/weight[c];
+			}
+		}
+	}
+
+	std::vector<std::vector<unsigned>> clusters(k);
+	for (unsigned i = 0; i < sites.size(); i++) clusters[assignment[i]].push_back(i);
+	clusters.erase(std::remove_if(clusters.begin(), clusters.end(),
+			[](const std::vector<unsigned>& c){ return c.empty(); }), clusters.end());
+	return clusters;
+}
+
+std::vector<Decomposition::Routes> Decomposition::solveClusters(const std::vector<std::vector<unsigned>>& clusters,
+		const SolveOptions& options, SolveStats& stats, const std::chrono::steady_clock::time_point deadline) const{
+	std::vector<Routes> results(clusters.size());
+	std::atomic<unsigned> next(0);
+	std::mutex lock;	//guards statistics and error
+	std::exception_ptr error;
+
+	auto worker=[&](){
+		//every worker reuses buffers of its colony
+		ACO aco;
+		if(colonySetup) colonySetup(aco);
+		try{
+			for(unsigned c=next++; c<clusters.size(); c=next++){
+				if(std::chrono::steady_clock::now()>=deadline) break;
+				aco.load(vrp.subProblem(clusters[c]));
+				SolveOptions clusterOptions;
+				clusterOptions.iterations=options.iterations;
+				clusterOptions.timeLimit=options.timeLimit;
+				clusterOptions.seed=options.seed==0 ? 0 : options.seed+c;
+				clusterOptions.cancel=options.cancel;
+				const SolveResult r=aco.solve(clusterOptions);
+
+				//customers of sub problem are numbered in order of cluster
+				for(const std::vector<unsigned>& route : r.routes){
+					results[c].push_back(std::vector<unsigned>());
+					for(unsigned id : route) results[c].back().push_back(clusters[c][id-1]);
+				}
+
+				std::lock_guard<std::mutex> guard(lock);
+				stats+=r.stats;
+			}
+		}catch(...){
+			std::lock_guard<std::mutex> guard(lock);
+			if(!error) error=std::current_exception();
+			next=clusters.size();
+		}
+	};
+
+	unsigned threads=workers>0 ? workers : std::thread::hardware_concurrency();
+	threads=std::max(1u, std::min<unsigned>(threads, clusters.size()));
+	std::vector<std::thread> pool;
+	for (unsigned t = 1; t < threads; t++) pool.push_back(std::thread(worker));
+	worker();
+	for(std::thread& t : pool) t.join();
+
+	if(error) std::rethrow_exception(error);
+	return results;
+}
+
+void Decomposition::polish(Routes& routes) const{
+	const double capacity=vrp.getVehicleCapacity();
+	const double maxTime=vrp.getMaxRouteTime();
+	const double dropTime=vrp.getDropTime();
+	auto dist=[this](const unsigned a, const unsigned b) -> double{
+		return VRP::distance(entity(a), entity(b));
+	};
+
+	for (unsigned pass = 0; pass < POLISH_PASSES; pass++) {
+		//load, time and centroid of every route
+		std::vector<double> load(routes.size(), 0), time(routes.size(), 0);
+		std::vector<Site> centroids(routes.size());
+		for (unsigned r = 0; r < routes.size(); r++) {
+			double x=0, y=0;
+			for(unsigned c : routes[r]){
+				load[r]+=entity(c).quantity;
+				x+=entity(c).p.x;
+				y+=entity(c).p.y;
+			}
+			time[r]=routeTime(routes[r]);
+			const double size=std::max<std::size_t>(routes[r].size(), 1);
+			centroids[r]=Site{x/size, y/size, static_cast<unsigned>(routes[r].size())};
+		}
+
+		//the nearest routes by centroid
+		std::vector<std::vector<unsigned>> neighbours(routes.size());
+		std::vector<std::pair<double, unsigned>> near;
+		for (unsigned r = 0; r < routes.size(); r++) {
+			near.clear();
+			for (unsigned o = 0; o < routes.size(); o++) {
+				if(o==r) continue;
+				const double dx=centroids[r].x-centroids[o].x, dy=centroids[r].y-centroids[o].y;
+				near.push_back(std::make_pair(dx*dx+dy*dy, o));
+			}
+			const unsigned k=std::min<std::size_t>(neighbourRoutes, near.size());
+			std::partial_sort(near.begin(), near.begin()+k, near.end());
+			for (unsigned i = 0; i < k; i++) neighbours[r].push_back(near[i].second);
+		}
+
+		//relocate customer to the best position in near route
+		bool improved=false;
+		for (unsigned a = 0; a < routes.size(); a++) {
+			for (unsigned p = 0; p < routes[a].size(); ) {
+				const unsigned c=routes[a][p];
+				const unsigned prev=p==0 ? 0 : routes[a][p-1];
+				const unsigned next=p+1==routes[a].size() ? 0 : routes[a][p+1];
+				const double gain=dist(prev, c)+dist(c, next)-dist(prev, next);
+
+				double bestDelta=gain;
+				unsigned bestRoute=a, bestPos=0;
+				for(unsigned b : neighbours[a]){
+					if(load[b]+entity(c).quantity>capacity) continue;
+					for (unsigned q = 0; q <= routes[b].size(); q++) {
+						const unsigned u=q==0 ? 0 : routes[b][q-1];
+						const unsigned v=q==routes[b].size() ? 0 : routes[b][q];
+						const double insertion=dist(u, c)+dist(c, v)-dist(u, v);
+						if(insertion<bestDelta-1e-9 && time[b]+insertion+dropTime<=maxTime){
+							bestDelta=insertion;
+							bestRoute=b;
+							bestPos=q;
+						}
+					}
+				}
+
+				if(bestRoute==a){
+					p++;
+					continue;
+				}
+				routes[a].erase(routes[a].begin()+p);
+				routes[bestRoute].insert(routes[bestRoute].begin()+bestPos, c);
+				load[a]-=entity(c).quantity;
+				load[bestRoute]+=entity(c).quantity;
+				time[a]-=gain+dropTime;
+				time[bestRoute]+=bestDelta+dropTime;
+				improved=true;
+			}
+		}
+
+		routes.erase(std::remove_if(routes.begin(), routes.end(),
+				[](const std::vector<unsigned>& r){ return r.empty(); }), routes.end());
+		if(!improved) break;
+	}
+}
+
+SolveResult Decomposition::solve(const SolveOptions& options){
+	typedef std::chrono::steady_clock Clock;
+	const Clock::time_point start=Clock::now();
+	auto elapsed=[&start]() -> double{
+		return std::chrono::duration<double>(Clock::now()-start).count();
+	};
+
+	std::random_device rd;
+	const unsigned seed=options.seed==0 ? rd() : options.seed;
+	const double totalDropTime=static_cast<double>(vrp.getDropTime())*vrp.getCustomers().size();
+
+	SolveResult result;
+	Routes routes;
+	double cost=std::numeric_limits<double>::infinity();	//with drop time
+	double lastReport=-std::numeric_limits<double>::infinity();
+	bool improved=false;	//since last report
+
+	unsigned round=0;
+	for(; round<std::max(rounds, 1u); round++){
+		if(options.cancel!=nullptr && options.cancel->load()){
+			result.cancelled=true;
+			break;
+		}
+		if(round>0 && options.timeLimit>0 && elapsed()>=options.timeLimit) break;
+
+		//the first round clusters customers, next ones are clustering routes of the actual solution
+		std::vector<Site> sites;
+		if(round==0){
+			for(const Entity& c : vrp.getCustomers()) sites.push_back(Site{double(c.p.x), double(c.p.y), 1});
+		}else{
+			for(const std::vector<unsigned>& r : routes){
+				double x=0, y=0;
+				for(unsigned c : r){
+					x+=entity(c).p.x;
+					y+=entity(c).p.y;
+				}
+				sites.push_back(Site{x/r.size(), y/r.size(), static_cast<unsigned>(r.size())});
+			}
+		}
+		const std::vector<std::vector<unsigned>> groups=partition(sites, round, seed+round);
+
+		std::vector<std::vector<unsigned>> clusters(groups.size());
+		std::vector<double> oldCost(groups.size(), 0);
+		for (unsigned g = 0; g < groups.size(); g++) {
+			for(unsigned s : groups[g]){
+				if(round==0){
+					clusters[g].push_back(s+1);	//customer ids are from one
+				}else{
+					clusters[g].insert(clusters[g].end(), routes[s].begin(), routes[s].end());
+					oldCost[g]+=routeTime(routes[s]);
+				}
+			}
+		}
+
+		//rest of time is divided between rounds and clusters solved by the same thread
+		SolveOptions clusterOptions;
+		clusterOptions.iterations=options.iterations;
+		clusterOptions.seed=options.seed==0 ? 0 : seed+round*groups.size();
+		clusterOptions.cancel=options.cancel;
+		if(options.timeLimit>0){
+			const unsigned threads=std::max(1u, workers>0 ? workers : std::thread::hardware_concurrency());
+			const double waves=std::ceil(static_cast<double>(groups.size())/threads);
+			clusterOptions.timeLimit=std::max(options.timeLimit-elapsed(), 0.0)/(std::max(rounds, 1u)-round)/waves;
+		}
+		//the first round must solve all clusters, next ones can keep old routes
+		Clock::time_point deadline=Clock::time_point::max();
+		if(round>0 && options.timeLimit>0){
+			deadline=start+std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.timeLimit));
+		}
+		std::vector<Routes> solved=solveClusters(clusters, clusterOptions, result.stats, deadline);
+
+		Routes newRoutes;
+		for (unsigned g = 0; g < groups.size(); g++) {
+			double newCost=0;
+			for(const std::vector<unsigned>& r : solved[g]) newCost+=routeTime(r);
+
+			if(solved[g].empty() && round==0){
+				//colony was stopped before its first iteration, every customer has its own route
+				for(unsigned c : clusters[g]) newRoutes.push_back(std::vector<unsigned>(1, c));
+			}else if(round==0 || (!solved[g].empty() && newCost<oldCost[g]-1e-9)){
+				newRoutes.insert(newRoutes.end(), solved[g].begin(), solved[g].end());
+			}else{
+				for(unsigned s : groups[g]) newRoutes.push_back(routes[s]);
+			}
+		}
+		routes.swap(newRoutes);
+
+		polish(routes);
+
+		double newCost=0;
+		for(const std::vector<unsigned>& r : routes) newCost+=routeTime(r);
+		if(newCost<cost){
+			cost=newCost;
+			improved=true;
+		}
+
+		if(options.progress){
+			const double now=elapsed();
+			if(now-lastReport>=options.progressInterval){
+				SolveProgress p;
+				p.iteration=round;
+				p.iterations=rounds;
+				p.bestCost=cost-totalDropTime;
+				p.elapsed=now;
+				p.improved=improved;
+				options.progress(p);
+				lastReport=now;
+				improved=false;
+			}
+		}
+	}
+
+	result.cost=cost-totalDropTime;
+	result.routes=routes;
+	result.iterations=round;
+	result.elapsed=elapsed();
+	if(options.cancel!=nullptr && options.cancel->load()) result.cancelled=true;
+	return result;
+}
+
+/*** End of file: Decomposition.cpp ***/
@@ -0,0 +1,221 @@
+/**
+ * Project: VRPAntColony
+ * @file Decomposition.h
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Header file of cluster first decomposition of big vehicle routing problems.
+ */
+
+#ifndef DECOMPOSITION_H_
+#define DECOMPOSITION_H_
+
+#include <vector>
+#include <chrono>
+#include <functional>
+#include "VRP.h"
+#include "ACO.h"
+
+/**
+ * Solver for big problems. Customers are partitioned into clusters and every cluster is solved
+ * as independent problem with its own colony (clusters are solved in parallel). Routes of all clusters
+ * are joined and polished with moves of customers between near routes.
+ * Next rounds are clustering routes of the actual solution (with shifted borders) and solve them again,
+ * new routes of cluster are used only when they are better.
+ */
+class Decomposition {
+public:
+	/**
+	 * Method of clustering.
+	 */
+	enum class Clustering{
+		SWEEP,	//! By angle around the depot.
+		KMEANS	//! K-means over coordinates.
+	};
+
+	/**
+	 * Decomposition initialization.
+	 *
+	 * @param[in] v
+	 * 	VRP problem.
+	 */
+	Decomposition(const VRP& v);
+
+	/**
+	 * Solves problem.
+	 * Iterations of options are used for every cluster (zero means 2n of cluster),
+	 * time limit is for whole solving, progress is reported after every round.
+	 *
+	 * @param[in] options
+	 * 	Options of solving.
+	 * @return Result of solving. Iterations are finished rounds.
+	 * @throw std::runtime_error When maximum route time or capacity is too small.
+	 */
+	SolveResult solve(const SolveOptions& options);
+
+	Clustering getClustering() const {
+		return clustering;
+	}
+
+	void setClustering(Clustering clustering = Clustering::SWEEP) {
+		this->clustering = clustering;
+	}
+
+	unsigned getClusterSize() const {
+		return clusterSize;
+	}
+
+	/**
+	 * Sets wanted number of customers in one cluster.
+	 * K-means clusters have this size only on average.
+	 *
+	 * @param[in] clusterSize
+	 * 	Number of customers.
+	 */
+	void setClusterSize(unsigned clusterSize = 100) {
+		this->clusterSize = clusterSize;
+	}
+
+	unsigned getRounds() const {
+		return rounds;
+	}
+
+	/**
+	 * Sets number of rounds. The first one clusters customers, others are clustering routes.
+	 *
+	 * @param[in] rounds
+	 * 	Number of rounds.
+	 */
+	void setRounds(unsigned rounds = 3) {
+		this->rounds = rounds;
+	}
+
+	unsigned getWorkers() const {
+		return workers;
+	}
+
+	/**
+	 * Sets number of threads that are solving clusters.
+	 *
+	 * @param[in] workers
+	 * 	Number of threads. Zero means number of CPUs.
+	 */
+	void setWorkers(unsigned workers = 0) {
+		this->workers = workers;
+	}
+
+	unsigned getNeighbourRoutes() const {
+		return neighbourRoutes;
+	}
+
+	/**
+	 * Sets number of the nearest routes (by centroid) where polishing tries to move customer.
+	 *
+	 * @param[in] neighbourRoutes
+	 * 	Number of routes.
+	 */
+	void setNeighbourRoutes(unsigned neighbourRoutes = 8) {
+		this->neighbourRoutes = neighbourRoutes;
+	}
+
+	/**
+	 * Sets function that sets parameters of colony of every worker.
+	 * It is called once for every colony before the first cluster is loaded.
+	 *
+	 * @param[in] setup
+	 * 	Function that sets parameters of colony.
+	 */
+	void setColonySetup(const std::function<void(ACO&)>& setup) {
+		colonySetup = setup;
+	}
+
+private:
+	typedef std::vector<std::vector<unsigned>> Routes;	//! Ids of customers for each vehicle route.
+
+	/**
+	 * Point that is clustered (customer or centroid of route).
+	 */
+	struct Site{
+		double x, y;
+		unsigned weight;	//! Number of customers.
+	};
+
+	VRP vrp;
+	Clustering clustering=Clustering::SWEEP;
+	unsigned clusterSize=100;	//! Wanted number of customers in one cluster.
+	unsigned rounds=3;	//! Number of rounds of clustering and solving.
+	unsigned workers=0;	//! Threads solving clusters. Zero means number of CPUs.
+	unsigned neighbourRoutes=8;	//! Number of near routes used by polishing.
+	std::function<void(ACO&)> colonySetup;	//! Sets parameters of colonies.
+
+	static constexpr unsigned KMEANS_ITERATIONS=20;	//! Maximal number of k-means iterations.
+	static constexpr unsigned POLISH_PASSES=10;	//! Maximal number of polishing passes.
+
+	/**
+	 * Partitions sites into clusters.
+	 *
+	 * @param[in] sites
+	 * 	Sites for clustering.
+	 * @param[in] round
+	 * 	Actual round. Shifts borders of clusters.
+	 * @param[in] seed
+	 * 	Seed for k-means.
+	 * @return Indices of sites for each cluster.
+	 */
+	std::vector<std::vector<unsigned>> partition(const std::vector<Site>& sites, const unsigned round,
+			const unsigned seed) const;
+
+	/**
+	 * Clusters sites by angle around depot.
+	 */
+	std::vector<std::vector<unsigned>> sweep(const std::vector<Site>& sites, const unsigned round) const;
+
+	/**
+	 * Clusters sites with k-means.
+	 */
+	std::vector<std::vector<unsigned>> kmeans(const std::vector<Site>& sites, const unsigned seed) const;
+
+	/**
+	 * Solves clusters in parallel.
+	 *
+	 * @param[in] clusters
+	 * 	Ids of customers of every cluster.
+	 * @param[in] options
+	 * 	Options for colonies.
+	 * @param[in|out] stats
+	 * 	Counters of colonies are added to it.
+	 * @param[in] deadline
+	 * 	Clusters that were not started before deadline are not solved.
+	 * @return Routes of every cluster (with ids of this problem). Empty when cluster was not solved.
+	 */
+	std::vector<Routes> solveClusters(const std::vector<std::vector<unsigned>>& clusters,
+			const SolveOptions& options, SolveStats& stats,
+			const std::chrono::steady_clock::time_point deadline=std::chrono::steady_clock::time_point::max()) const;
+
+	/**
+	 * Moves customers between near routes while it decreases cost.
+	 *
+	 * @param[in|out] routes
+	 * 	Routes for polishing. Empty routes are removed.
+	 */
+	void polish(Routes& routes) const;
+
+	/**
+	 * Cost of route with drop times.
+	 *
+	 * @param[in] route
+	 * 	Ids of customers of route.
+	 * @return Time of route.
+	 */
+	double routeTime(const std::vector<unsigned>& route) const;
+
+	/**
+	 * Customer or depot with given id.
+	 */
+	const Entity& entity(const unsigned id) const {
+		return id==0 ? vrp.getDepot() : vrp.getCustomers()[id-1];
+	}
+};
+
+#endif /* DECOMPOSITION_H_ */
+
+/*** End of file: Decomposition.h ***/
@@ -0,0 +1,357 @@
+/**
+ * Project: VRPAntColony
+ * @file Kernels.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief  Source file of vectorized kernels working on contiguous edge data.
+ */
+
+#include "Kernels.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace{
+
+/**
+ * Maximal exponent that is calculated with multiplications.
+ */
+const unsigned MAX_INT_EXPONENT=64;
+
+/**
+ * Checks if exponent can be calculated with multiplications.
+ *
+ * @param[in] e
+ * 	Exponent.
+ * @return True for small non negative integer.
+ */
+bool intExponent(const double e){
+	return e>=0 && e<=MAX_INT_EXPONENT && e==std::floor(e);
+}
+
+/**
+ * Power with exponentiation by squaring. Vectorized variants are using
+ * the same sequence of multiplications so they give the same results.
+ * It is used by scalar kernels too, so results do not depend on instruction set,
+ * but they may differ from std::pow in the last bits.
+ */
+inline double ipow(double x, unsigned k){
+	double res=1;
+	while(k){
+		if(k&1) res*=x;
+		k>>=1;
+		if(k) x*=x;
+	}
+	return res;
+}
+
+double savingsScalar(const double* d0, const double* dist, const double d0i,
+		const double g, const double f, double* out, const std::size_t n){
+	double minV=std::numeric_limits<double>::infinity();
+	for(std::size_t j=0; j<n; j++){
+		out[j]=d0i+d0[j]-g*dist[j]+f*std::abs(d0i-d0[j]);
+		if(minV>out[j]) minV=out[j];
+	}
+	return minV;
+}
+
+void shiftPowScalar(double* x, const std::size_t n, const double shift, const double e){
+	if(intExponent(e)){
+		for(std::size_t i=0; i<n; i++) x[i]=ipow(x[i]+shift, static_cast<unsigned>(e));
+	}else{
+		for(std::size_t i=0; i<n; i++) x[i]=std::pow(x[i]+shift, e);
+	}
+}
+
+void scaleScalar(double* x, const std::size_t n, const double factor){
+	for(std::size_t i=0; i<n; i++) x[i]=factor*x[i];
+}
+
+void choiceInfoScalar(const double* tau, const double* vis, const double alfa,
+		double* out, const std::size_t n){
+	if(intExponent(alfa)){
+		for(std::size_t i=0; i<n; i++) out[i]=ipow(tau[i], static_cast<unsigned>(alfa))*vis[i];
+	}else{
+		for(std::size_t i=0; i<n; i++) out[i]=std::pow(tau[i], alfa)*vis[i];
+	}
+}
+
+#ifdef KERNELS_X86
+
+__attribute__((target("avx2")))
+inline __m256d ipow256(__m256d x, unsigned k){
+	__m256d res=_mm256_set1_pd(1);
+	while(k){
+		if(k&1) res=_mm256_mul_pd(res, x);
+		k>>=1;
+		if(k) x=_mm256_mul_pd(x, x);
+	}
+	return res;
+}
+
+__attribute__((target("avx2")))
+double savingsAvx2(const double* d0, const double* dist, const double d0i,
+		const double g, const double f, double* out, const std::size_t n){
+	const __m256d vD0i=_mm256_set1_pd(d0i);
+	const __m256d vG=_mm256_set1_pd(g);
+	const __m256d vF=_mm256_set1_pd(f);
+	const __m256d signMask=_mm256_set1_pd(-0.0);
+	__m256d vMin=_mm256_set1_pd(std::numeric_limits<double>::infinity());
+	std::size_t j=0;
+	for(; j+4<=n; j+=4){
+		__m256d vD0=_mm256_loadu_pd(d0+j);
+		__m256d vDist=_mm256_loadu_pd(dist+j);
+		__m256d diff=_mm256_andnot_pd(signMask, _mm256_sub_pd(vD0i, vD0));
+		__m256d r=_mm256_add_pd(
+				_mm256_sub_pd(_mm256_add_pd(vD0i, vD0), _mm256_mul_pd(vG, vDist)),
+				_mm256_mul_pd(vF, diff));
+		_mm256_storeu_pd(out+j, r);
+		vMin=_mm256_min_pd(vMin, r);
+	}
+	double m[4];
+	_mm256_storeu_pd(m, vMin);
+	double minV=std::min(std::min(m[0], m[1]), std::min(m[2], m[3]));
+	return std::min(minV, savingsScalar(d0+j, dist+j, d0i, g, f, out+j, n-j));
+}
+
+__attribute__((target("avx2")))
+void shiftPowAvx2(double* x, const std::size_t n, const double shift, const double e){
+	if(!intExponent(e)){
+		shiftPowScalar(x, n, shift, e);
+		return;
+	}
+	const unsigned k=static_cast<unsigned>(e);
+	const __m256d vShift=_mm256_set1_pd(shift);
+	std::size_t i=0;
+	for(; i+4<=n; i+=4){
+		_mm256_storeu_pd(x+i, ipow256(_mm256_add_pd(_mm256_loadu_pd(x+i), vShift), k));
+	}
+	shiftPowScalar(x+i, n-i, shift, e);
+}
+
+__attribute__((target("avx2")))
+void scaleAvx2(double* x, const std::size_t n, const double factor){
+	const __m256d vF=_mm256_set1_pd(factor);
+	std::size_t i=0;
+	for(; i+4<=n; i+=4){
+		_mm256_storeu_pd(x+i, _mm256_mul_pd(vF, _mm256_loadu_pd(x+i)));
+	}
+	scaleScalar(x+i, n-i, factor);
+}
+
+__attribute__((target("avx2")))
+void choiceInfoAvx2(const double* tau, const double* vis, const double alfa,
+		double* out, const std::size_t n){
+	if(!intExponent(alfa)){
+		choiceInfoScalar(tau, vis, alfa, out, n);
+		return;
+	}
+	const unsigned k=static_cast<unsigned>(alfa);
+	std::size_t i=0;
+	for(; i+4<=n; i+=4){
+		_mm256_storeu_pd(out+i, _mm256_mul_pd(ipow256(_mm256_loadu_pd(tau+i), k), _mm256_loadu_pd(vis+i)));
+	}
+	choiceInfoScalar(tau+i, vis+i, alfa, out+i, n-i);
+}
+
+__attribute__((target("avx512f")))
+inline __m512d ipow512(__m512d x, unsigned k){
+	__m512d res=_mm512_set1_pd(1);
+	while(k){
+		if(k&1) res=_mm512_mul_pd(res, x);
+		k>>=1;
+		if(k) x=_mm512_mul_pd(x, x);
+	}
+	return res;
+}
+
+__attribute__((target("avx512f")))
+double savingsAvx512(const double* d0, const double* dist, const double d0i,
+		const double g, const double f, double* out, const std::size_t n){
+	const __m512d vD0i=_mm512_set1_pd(d0i);
+	const __m512d vG=_mm512_set1_pd(g);
+	const __m512d vF=_mm512_set1_pd(f);
+	__m512d vMin=_mm512_set1_pd(std::numeric_limits<double>::infinity());
+	std::size_t j=0;
+	for(; j+8<=n; j+=8){
+		__m512d vD0=_mm512_loadu_pd(d0+j);
+		__m512d vDist=_mm512_loadu_pd(dist+j);
+		__m512d diff=_mm512_sub_pd(vD0i, vD0);
+		diff=_mm512_mask_max_pd(diff, 0xFF, diff, _mm512_sub_pd(_mm512_setzero_pd(), diff));
+		__m512d r=_mm512_add_pd(
+				_mm512_sub_pd(_mm512_add_pd(vD0i, vD0), _mm512_mul_pd(vG, vDist)),
+				_mm512_mul_pd(vF, diff));
+		_mm512_storeu_pd(out+j, r);
+		vMin=_mm512_mask_min_pd(vMin, 0xFF, vMin, r);
+	}
+	double m[8];
+	_mm512_storeu_pd(m, vMin);
+	double minV=*std::min_element(m, m+8);
+	return std::min(minV, savingsScalar(d0+j, dist+j, d0i, g, f, out+j, n-j));
+}
+
+__attribute__((target("avx512f")))
+void shiftPowAvx512(double* x, const std::size_t n, const double shift, const double e){
+	if(!intExponent(e)){
+		shiftPowScalar(x, n, shift, e);
+		return;
+	}
+	const unsigned k=static_cast<unsigned>(e);
+	const __m512d vShift=_mm512_set1_pd(shift);
+	std::size_t i=0;
+	for(; i+8<=n; i+=8){
+		_mm512_storeu_pd(x+i, ipow512(_mm512_add_pd(_mm512_loadu_pd(x+i), vShift), k));
+	}
+	shiftPowScalar(x+i, n-i, shift, e);
+}
+
+__attribute__((target("avx512f")))
+void scaleAvx512(double* x, const std::size_t n, const double factor){
+	const __m512d vF=_mm512_set1_pd(factor);
+	std::size_t i=0;
+	for(; i+8<=n; i+=8){
+		_mm512_storeu_pd(x+i, _mm512_mul_pd(vF, _mm512_loadu_pd(x+i)));
+	}
+	scaleScalar(x+i, n-i, factor);
+}
+
+__attribute__((target("avx512f")))
+void choiceInfoAvx512(const double* tau, const double* vis, const double alfa,
+		double* out, const std::size_t n){
+	if(!intExponent(alfa)){
+		choiceInfoScalar(tau, vis, alfa, out, n);
+		return;
+	}
+	const unsigned k=static_cast<unsigned>(alfa);
+	std::size_t i=0;
+	for(; i+8<=n; i+=8){
+		_mm512_storeu_pd(out+i, _mm512_mul_pd(ipow512(_mm512_loadu_pd(tau+i), k), _mm512_loadu_pd(vis+i)));
+	}
+	choiceInfoScalar(tau+i, vis+i, alfa, out+i, n-i);
+}
+
+#endif
+
+/**
+ * Table of kernels for one instruction set.
+ */
+struct KernelTable{
+	Kernels::Isa isa;
+	double (*savings)(const double*, const double*, const double, const double, const double, double*, const std::size_t);
+	void (*shiftPow)(double*, const std::size_t, const double, const double);
+	void (*scale)(double*, const std::size_t, const double);
+	void (*choiceInfo)(const double*, const double*, const double, double*, const std::size_t);
+};
+
+const KernelTable scalarTable={Kernels::Isa::SCALAR, savingsScalar, shiftPowScalar, scaleScalar, choiceInfoScalar};
+#ifdef KERNELS_X86
+const KernelTable avx2Table={Kernels::Isa::AVX2, savingsAvx2, shiftPowAvx2, scaleAvx2, choiceInfoAvx2};
+const KernelTable avx512Table={Kernels::Isa::AVX512, savingsAvx512, shiftPowAvx512, scaleAvx512, choiceInfoAvx512};
+#endif
+
+/**
+ * Checks if CPU supports given instruction set.
+ */
+bool supported(const Kernels::Isa isa){
+	switch(isa){
+	case Kernels::Isa::SCALAR:
+		return true;
+	#ifdef KERNELS_X86
+	case Kernels::Isa::AVX2:
+		return __builtin_cpu_supports("avx2");
+	case Kernels::Isa::AVX512:
+		return __builtin_cpu_supports("avx512f");
+	#endif
+	default:
+		return false;
+	}
+}
+
+const KernelTable* tableFor(const Kernels::Isa isa){
+	#ifdef KERNELS_X86
+	if(isa==Kernels::Isa::AVX512) return &avx512Table;
+	if(isa==Kernels::Isa::AVX2) return &avx2Table;
+	#endif
+	(void)isa;
+	return &scalarTable;
+}
+
+/**
+ * Selects the best supported instruction set.
+ */
+const KernelTable* detect(){
+	if(supported(Kernels::Isa::AVX512)) return tableFor(Kernels::Isa::AVX512);
+	if(supported(Kernels::Isa::AVX2)) return tableFor(Kernels::Isa::AVX2);
+	return &scalarTable;
+}
+
+/**
+ * Table of used kernels. It is atomic, because setIsa may be called while other threads are calling kernels.
+ */
+std::atomic<const KernelTable*>& table(){
+	static std::atomic<const KernelTable*> t(detect());
+	return t;
+}
+
+const KernelTable* active(){
+	return table().load(std::memory_order_acquire);
+}
+
+}
+
+Kernels::Isa Kernels::getIsa(){
+	return active()->isa;
+}
+
+bool Kernels::setIsa(Isa isa){
+	if(!supported(isa)) return false;
+	table().store(tableFor(isa), std::memory_order_release);
+	return true;
+}
+
+const char* Kernels::isaName(Isa isa){
+	switch(isa){
+	case Isa::AVX2:
+		return "avx2";
+	case Isa::AVX512:
+		return "avx512";
+	default:
+		return "scalar";
+	}
+}
+
+double Kernels::savings(const double* d0, const double* dist, const double d0i,
+		const double g, const double f, double* out, const std::size_t n){
+	return active()->savings(d0, dist, d0i, g, f, out, n);
+}
+
+void Kernels::shiftPow(double* x, const std::size_t n, const double shift, const double e){
+	active()->shiftPow(x, n, shift, e);
+}
+
+void Kernels::scale(double* x, const std::size_t n, const double factor){
+	active()->scale(x, n, factor);
+}
+
+void Kernels::choiceInfo(const double* tau, const double* vis, const double alfa,
+		double* out, const std::size_t n){
+	active()->choiceInfo(tau, vis, alfa, out, n);
+}
+
+void Kernels::choiceInfo(const double* tau, const double* vis, const double alfa,
+		double* out, const unsigned* index, const std::size_t n){
+	if(intExponent(alfa)){
+		const unsigned k=static_cast<unsigned>(alfa);
+		for(std::size_t i=0; i<n; i++) out[index[i]]=ipow(tau[index[i]], k)*vis[index[i]];
+	}else{
+		for(std::size_t i=0; i<n; i++) out[index[i]]=std::pow(tau[index[i]], alfa)*vis[index[i]];
+	}
+}
+
+/*** End of file: Kernels.cpp ***/
@@ -0,0 +1,147 @@
+/**
+ * Project: VRPAntColony
+ * @file Kernels.h
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Header file of vectorized kernels working on contiguous edge data.
+ */
+
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+#include <cstddef>
+
+/**
+ * Numeric kernels used by ant colony for operations over all edges.
+ * Every kernel has scalar, AVX2 and AVX-512 implementation. Implementation is selected
+ * at runtime according to the CPU. All implementations give the same results, because
+ * they are using the same sequence of operations (no fused multiply add).
+ */
+class Kernels {
+public:
+
+	/**
+	 * Instruction set used by kernels.
+	 */
+	enum class Isa{
+		SCALAR, AVX2, AVX512
+	};
+
+	/**
+	 * Instruction set that is actually used.
+	 *
+	 * @return Used instruction set.
+	 */
+	static Isa getIsa();
+
+	/**
+	 * Forces kernels to use given instruction set.
+	 * It is safe to call it while other threads are using kernels (they switch on their next call).
+	 *
+	 * @param[in] isa
+	 * 	Instruction set to use.
+	 * @return False when CPU does not support given instruction set. In that case nothing is changed.
+	 */
+	static bool setIsa(Isa isa);
+
+	/**
+	 * Name of instruction set.
+	 *
+	 * @param[in] isa
+	 * 	Instruction set.
+	 * @return Name of instruction set.
+	 */
+	static const char* isaName(Isa isa);
+
+	/**
+	 * Calculates savings based visibility for arcs of one vertex i:
+	 * 	out[j]=d0i+d0[j]-g*dist[j]+f*|d0i-d0[j]|
+	 *
+	 * @param[in] d0
+	 * 	Distances to depot of the other vertices.
+	 * @param[in] dist
+	 * 	Distances between vertex i and the other vertices.
+	 * @param[in] d0i
+	 * 	Distance of vertex i to depot.
+	 * @param[in] g
+	 * 	Parameter g of visibility.
+	 * @param[in] f
+	 * 	Parameter f of visibility.
+	 * @param[out] out
+	 * 	Calculated visibilities.
+	 * @param[in] n
+	 * 	Number of arcs.
+	 * @return Minimal calculated visibility. Infinity for n==0.
+	 */
+	static double savings(const double* d0, const double* dist, const double d0i,
+			const double g, const double f, double* out, const std::size_t n);
+
+	/**
+	 * Shifts and powers values: x[i]=(x[i]+shift)^e
+	 *
+	 * @param[in|out] x
+	 * 	Values for transformation.
+	 * @param[in] n
+	 * 	Number of values.
+	 * @param[in] shift
+	 * 	Added value.
+	 * @param[in] e
+	 * 	Exponent. Only small non negative integer exponents are vectorized.
+	 */
+	static void shiftPow(double* x, const std::size_t n, const double shift, const double e);
+
+	/**
+	 * Multiplies all values by factor: x[i]=factor*x[i]
+	 * It is used for pheromone evaporation.
+	 *
+	 * @param[in|out] x
+	 * 	Values for multiplication.
+	 * @param[in] n
+	 * 	Number of values.
+	 * @param[in] factor
+	 * 	Multiplication factor.
+	 */
+	static void scale(double* x, const std::size_t n, const double factor);
+
+	/**
+	 * Calculates choice info: out[i]=tau[i]^alfa*vis[i]
+	 *
+	 * @param[in] tau
+	 * 	Pheromones.
+	 * @param[in] vis
+	 * 	Visibilities (already powered by beta).
+	 * @param[in] alfa
+	 * 	Exponent for pheromone. Only small non negative integer exponents are vectorized.
+	 * @param[out] out
+	 * 	Calculated choice info.
+	 * @param[in] n
+	 * 	Number of values.
+	 */
+	static void choiceInfo(const double* tau, const double* vis, const double alfa,
+			double* out, const std::size_t n);
+
+	/**
+	 * Calculates choice info only for selected indices: out[index[i]]=tau[index[i]]^alfa*vis[index[i]]
+	 * This variant is not vectorized, but gives the same results as the one for all values.
+	 *
+	 * @param[in] tau
+	 * 	Pheromones.
+	 * @param[in] vis
+	 * 	Visibilities (already powered by beta).
+	 * @param[in] alfa
+	 * 	Exponent for pheromone.
+	 * @param[out] out
+	 * 	Calculated choice info.
+	 * @param[in] index
+	 * 	Selected indices.
+	 * @param[in] n
+	 * 	Number of indices.
+	 */
+	static void choiceInfo(const double* tau, const double* vis, const double alfa,
+			double* out, const unsigned* index, const std::size_t n);
+
+};
+
+#endif /* KERNELS_H_ */
+
+/*** End of file: Kernels.h ***/
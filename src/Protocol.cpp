@@ -0,0 +1,154 @@
+/**
+ * Project: VRPAntColony
+ * @file Protocol.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief  Source file of line protocol used by solver daemon.
+ */
+
+#include "Protocol.h"
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+FdReader::FdReader(const int fd) :fd(fd), buffer(64*1024) {}
+
+bool FdReader::readLine(std::string& line){
+	line.clear();
+	while(true){
+		for(std::size_t i=pos; i<end; i++){
+			if(buffer[i]=='\n'){
+				line.append(&buffer[pos], i-pos);
+				pos=i+1;
+				if(!line.empty() && line.back()=='\r') line.pop_back();
+				return true;
+			}
+		}
+		line.append(&buffer[0]+pos, end-pos);
+		pos=end=0;
+
+		ssize_t r=read(fd, &buffer[0], buffer.size());
+		if(r<0 && errno==EINTR) continue;
+		if(r<=0){
+			//last line without new line character
+			return !line.empty();
+		}
+		end=r;
+	}
+}
+
+bool writeAll(const int fd, const std::string& data){
+	std::size_t written=0;
+	while(written<data.size()){
+		ssize_t w=send(fd, data.data()+written, data.size()-written, MSG_NOSIGNAL);
+		if(w<0 && errno==ENOTSOCK) w=write(fd, data.data()+written, data.size()-written);
+		if(w<0 && errno==EINTR) continue;
+		if(w<=0) return false;
+		written+=w;
+	}
+	return true;
+}
+
+/**
+ * Parses non negative integer of request header.
+ *
+ * @param[in] value
+ * 	Field of header.
+ * @param[in] name
+ * 	Name of field for error message.
+ * @return Parsed number.
+ * @throw std::runtime_error	Value is not a number, it is negative or it does not fit to unsigned.
+ */
+static unsigned parseUnsigned(const std::string& value, const char* name){
+	//parsed as signed, so -1 does not wrap around
+	char* end=nullptr;
+	errno=0;
+	const long long n=std::strtoll(value.c_str(), &end, 10);
+	if(value.empty() || *end!='\0' || errno==ERANGE || n<0 || n>std::numeric_limits<unsigned>::max()){
+		throw std::runtime_error(std::string("Invalid ")+name+" in request header: "+value);
+	}
+	return static_cast<unsigned>(n);
+}
+
+bool readRequest(FdReader& reader, SolveRequest& request, const unsigned long maxCustomers){
+	std::string line;
+	//skip empty lines between requests
+	do{
+		if(!reader.readLine(line)) return false;
+	}while(line.find_first_not_of(" \t")==std::string::npos);
+
+	std::istringstream header(line);
+	std::string command;
+	header >> command >> request.id;
+	if(command!="SOLVE" || request.id.empty()){
+		throw std::runtime_error("Invalid request header: "+line);
+	}
+	request.iterations=0;
+	request.timeLimit=0;
+	request.seed=0;
+	std::string value;
+	if(header >> value) request.iterations=parseUnsigned(value, "iterations");
+	if(header >> value){
+		char* end=nullptr;
+		request.timeLimit=std::strtod(value.c_str(), &end);
+		if(*end!='\0' || !std::isfinite(request.timeLimit) || request.timeLimit<0){
+			throw std::runtime_error("Invalid time limit in request header: "+value);
+		}
+	}
+	if(header >> value) request.seed=parseUnsigned(value, "seed");
+	if(header >> value) throw std::runtime_error("Invalid request header: "+line);
+
+	//first line of problem says number of customers
+	//than there is depot line and line for each customer
+	if(!reader.readLine(line)) throw std::runtime_error("Request without problem.");
+	request.problem=line;
+	request.problem+='\n';
+
+	unsigned long customers=0;
+	std::istringstream(line) >> customers;
+	if(customers>maxCustomers){
+		throw std::runtime_error("Too many customers: "+std::to_string(customers)+" (at most "
+				+std::to_string(maxCustomers)+").");
+	}
+	for(unsigned long i=0; i<customers+1; i++){
+		if(!reader.readLine(line)) throw std::runtime_error("Request with incomplete problem.");
+		request.problem+=line;
+		request.problem+='\n';
+	}
+	return true;
+}
+
+std::string formatRequest(const SolveRequest& request){
+	std::ostringstream out;
+	out << "SOLVE " << request.id << " " << request.iterations << " " << request.timeLimit << " "
+			<< request.seed << "\n" << request.problem;
+	if(!request.problem.empty() && request.problem.back()!='\n') out << "\n";
+	return out.str();
+}
+
+std::string formatResult(const std::string& id, const SolveResult& result){
+	std::ostringstream out;
+	out.precision(10);
+	out << "RESULT " << id << " " << result.cost << " " << result.iterations << " " << result.elapsed << "\n";
+	for(const std::vector<unsigned>& r : result.routes){
+		out << 0;
+		for(unsigned c : r) out << " " << c;
+		out << " ";
+	}
+	out << 0 << "\n";
+	return out.str();
+}
+
+std::string formatError(const std::string& id, const std::string& message){
+	std::string m=message;
+	for(char& c : m) if(c=='\n') c=' ';
+	return "ERROR "+id+"\n"+m+"\n";
+}
+
+/*** End of file: Protocol.cpp ***/
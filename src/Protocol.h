@@ -0,0 +1,128 @@
+/**
+ * Project: VRPAntColony
+ * @file Protocol.h
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Header file of line protocol used by solver daemon.
+ *
+ * Request:
+ * 	SOLVE id iterations timeLimit seed
+ * 	problem in the same format as files in folder solve (first line says number of customers)
+ *
+ * Response has always two lines:
+ * 	RESULT id cost iterations elapsed
+ * 	routes (ids of visited vertices, depot is 0)
+ * or
+ * 	ERROR id
+ * 	message (cancelled when daemon stops before the request is solved)
+ */
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <string>
+#include <vector>
+#include "ACO.h"
+
+/**
+ * Buffered reading of lines from file descriptor.
+ */
+class FdReader {
+public:
+	/**
+	 * Creates reader.
+	 *
+	 * @param[in] fd
+	 * 	File descriptor for reading. Reader does not close it.
+	 */
+	FdReader(const int fd);
+
+	/**
+	 * Reads one line (without new line character).
+	 *
+	 * @param[out] line
+	 * 	Read line.
+	 * @return False on end of file or error.
+	 */
+	bool readLine(std::string& line);
+
+private:
+	int fd;
+	std::vector<char> buffer;
+	std::size_t pos=0;
+	std::size_t end=0;
+};
+
+/**
+ * Writes all data to file descriptor.
+ *
+ * @param[in] fd
+ * 	File descriptor for writing.
+ * @param[in] data
+ * 	Data for writing.
+ * @return False on error.
+ */
+bool writeAll(const int fd, const std::string& data);
+
+/**
+ * Request for solving one problem.
+ */
+struct SolveRequest{
+	std::string id;	//! Identifier of request, it is copied to the response.
+	unsigned iterations=0;	//! Zero means 2n.
+	double timeLimit=0;	//! Zero means no limit.
+	unsigned seed=0;	//! Zero means random seed.
+	std::string problem;	//! Problem in format of files in folder solve.
+};
+
+//! Default maximal number of customers of requested problem. Solver has arrays of all arcs (n^2).
+constexpr unsigned long DEFAULT_MAX_CUSTOMERS=5000;
+
+/**
+ * Reads request.
+ *
+ * @param[in] reader
+ * 	Source of request.
+ * @param[out] request
+ * 	Read request.
+ * @param[in] maxCustomers
+ * 	Problem with more customers is rejected before it is read.
+ * @return False on end of file.
+ * @throw std::runtime_error	Invalid request (e.g. negative or not numeric fields of header) or too many customers.
+ */
+bool readRequest(FdReader& reader, SolveRequest& request, const unsigned long maxCustomers=DEFAULT_MAX_CUSTOMERS);
+
+/**
+ * Serializes request.
+ *
+ * @param[in] request
+ * 	Request for serialization.
+ * @return Request in protocol format.
+ */
+std::string formatRequest(const SolveRequest& request);
+
+/**
+ * Serializes result.
+ *
+ * @param[in] id
+ * 	Identifier of request.
+ * @param[in] result
+ * 	Result of solving.
+ * @return Response in protocol format.
+ */
+std::string formatResult(const std::string& id, const SolveResult& result);
+
+/**
+ * Serializes error.
+ *
+ * @param[in] id
+ * 	Identifier of request.
+ * @param[in] message
+ * 	Error message.
+ * @return Response in protocol format.
+ */
+std::string formatError(const std::string& id, const std::string& message);
+
+#endif /* PROTOCOL_H_ */
+
+/*** End of file: Protocol.h ***/
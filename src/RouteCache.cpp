@@ -0,0 +1,52 @@
+/**
+ * Project: VRPAntColony
+ * @file RouteCache.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief  Source file of cache of already optimized vehicle routes.
+ */
+
+#include "RouteCache.h"
+
+RouteCache::RouteCache(const std::size_t slots) :slots(slots), locks(new std::mutex[LOCKS]), hits(0), misses(0) {}
+
+void RouteCache::resize(const std::size_t slots){
+	for(unsigned i=0; i<LOCKS; i++) locks[i].lock();
+	this->slots.clear();
+	this->slots.resize(slots);
+	for(unsigned i=0; i<LOCKS; i++) locks[i].unlock();
+}
+
+void RouteCache::clear(){
+	for(unsigned i=0; i<LOCKS; i++) locks[i].lock();
+	for(Slot& s : slots) s.used=false;
+	for(unsigned i=0; i<LOCKS; i++) locks[i].unlock();
+}
+
+bool RouteCache::lookup(const Key& key, std::vector<unsigned>& order){
+	if(slots.empty()) return false;
+
+	const std::size_t index=slotIndex(key);
+	std::lock_guard<std::mutex> guard(locks[index%LOCKS]);
+	const Slot& s=slots[index];
+	if(!s.used || !(s.key==key)){
+		misses++;
+		return false;
+	}
+	order=s.order;
+	hits++;
+	return true;
+}
+
+void RouteCache::store(const Key& key, const std::vector<unsigned>& order){
+	if(slots.empty()) return;
+
+	const std::size_t index=slotIndex(key);
+	std::lock_guard<std::mutex> guard(locks[index%LOCKS]);
+	Slot& s=slots[index];
+	s.key=key;
+	s.used=true;
+	s.order=order;
+}
+
+/*** End of file: RouteCache.cpp ***/
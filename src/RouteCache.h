@@ -0,0 +1,152 @@
+/**
+ * Project: VRPAntColony
+ * @file RouteCache.h
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Header file of cache of already optimized vehicle routes.
+ */
+
+#ifndef ROUTECACHE_H_
+#define ROUTECACHE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <atomic>
+
+/**
+ * Bounded thread safe cache that maps set of customers of one vehicle route
+ * to already optimized order of these customers.
+ * Cache is direct mapped, so new route replaces the old one with the same slot.
+ */
+class RouteCache {
+public:
+
+	/**
+	 * Order insensitive fingerprint of route.
+	 */
+	struct Key{
+		std::uint64_t a=0;	//! sum of hashes of customers
+		std::uint64_t b=0;	//! sum of other hashes of customers
+		unsigned load=0;	//! filled capacity
+		unsigned size=0;	//! number of customers
+
+		/**
+		 * Adds customer to fingerprint.
+		 *
+		 * @param[in] id
+		 * 	Id of customer.
+		 * @param[in] quantity
+		 * 	Quantity of customer.
+		 */
+		void add(const unsigned id, const unsigned quantity){
+			a+=mix(id);
+			b+=mix(id^0x5bd1e995u);
+			load+=quantity;
+			size++;
+		}
+
+		bool operator==(const Key& o) const{
+			return a==o.a && b==o.b && load==o.load && size==o.size;
+		}
+	};
+
+	/**
+	 * Creates cache.
+	 *
+	 * @param[in] slots
+	 * 	Maximal number of cached routes. Zero disables the cache.
+	 */
+	RouteCache(const std::size_t slots=4096);
+
+	/**
+	 * Changes maximal number of cached routes. Removes all routes.
+	 *
+	 * @param[in] slots
+	 * 	Maximal number of cached routes. Zero disables the cache.
+	 */
+	void resize(const std::size_t slots);
+
+	/**
+	 * Removes all routes.
+	 */
+	void clear();
+
+	/**
+	 * Searches optimized route.
+	 *
+	 * @param[in] key
+	 * 	Fingerprint of route.
+	 * @param[out] order
+	 * 	Optimized order of customer ids.
+	 * @return True when route was found.
+	 */
+	bool lookup(const Key& key, std::vector<unsigned>& order);
+
+	/**
+	 * Stores optimized route.
+	 *
+	 * @param[in] key
+	 * 	Fingerprint of route.
+	 * @param[in] order
+	 * 	Optimized order of customer ids.
+	 */
+	void store(const Key& key, const std::vector<unsigned>& order);
+
+	std::size_t getSlots() const {
+		return slots.size();
+	}
+
+	unsigned long long getHits() const {
+		return hits;
+	}
+
+	unsigned long long getMisses() const {
+		return misses;
+	}
+
+	/**
+	 * Resets hits and misses counters.
+	 */
+	void resetCounters(){
+		hits=0;
+		misses=0;
+	}
+
+private:
+	/**
+	 * One cached route.
+	 */
+	struct Slot{
+		Key key;
+		bool used=false;
+		std::vector<unsigned> order;
+	};
+
+	static const unsigned LOCKS=64;	//! Number of locks (slots are divided between them).
+
+	std::vector<Slot> slots;
+	std::unique_ptr<std::mutex[]> locks;
+	std::atomic<unsigned long long> hits;
+	std::atomic<unsigned long long> misses;
+
+	/**
+	 * Hash function for one customer (splitmix64 finalizer).
+	 */
+	static std::uint64_t mix(std::uint64_t x){
+		x+=0x9e3779b97f4a7c15ull;
+		x=(x^(x>>30))*0xbf58476d1ce4e5b9ull;
+		x=(x^(x>>27))*0x94d049bb133111ebull;
+		return x^(x>>31);
+	}
+
+	std::size_t slotIndex(const Key& key) const{
+		return (key.a^(key.b>>17)^key.load)%slots.size();
+	}
+};
+
+#endif /* ROUTECACHE_H_ */
+
+/*** End of file: RouteCache.h ***/
@@ -9,8 +9,16 @@
 #include "VRP.h"
 #include <string>
 #include <sstream>
+#include <stdexcept>
+#include <algorithm>
 
 VRP::VRP(std::istream& input) {
+	//text format starts with number
+	if(input.peek()==static_cast<int>(BINARY_MAGIC&0xff)){
+		loadBinary(input);
+		return;
+	}
+
 	std::string line;
 	std::stringstream sLine;
 	//first line consists of:
@@ -62,4 +70,70 @@ VRP::VRP(std::istream& input) {
 
 }
 
+void VRP::loadBinary(std::istream& input){
+	//numbers are decoded from bytes, so the format does not depend on endianness of machine
+	std::vector<unsigned char> buffer;
+	auto read=[&](const std::size_t numbers) -> const unsigned char*{
+		buffer.resize(numbers*4);
+		if(!input.read(reinterpret_cast<char*>(buffer.data()), buffer.size())){
+			throw std::runtime_error("VRP: invalid input. Binary format is truncated.");
+		}
+		return buffer.data();
+	};
+	auto number=[](const unsigned char* b) -> std::uint32_t{
+		return b[0] | (b[1]<<8) | (b[2]<<16) | (static_cast<std::uint32_t>(b[3])<<24);
+	};
+
+	const unsigned char* header=read(8);
+	if(number(header)!=BINARY_MAGIC || number(header+4)!=BINARY_VERSION){
+		throw std::runtime_error("VRP: invalid input. Unknown binary format.");
+	}
+	unsigned numberOfCustomers=number(header+8);
+	vehicleCapacity=number(header+12);
+	maxRouteTime=number(header+16);
+	dropTime=number(header+20);
+	depot.id=0;
+	depot.type=EnityType::DEPOT;
+	depot.quantity=0;
+	depot.p.x=number(header+24);
+	depot.p.y=number(header+28);
+
+	//customers are read in blocks
+	//number of customers is not trusted before they are read (corrupted file would allocate too much)
+	const unsigned block=4096;
+	customers.reserve(std::min(block, numberOfCustomers));
+	while(numberOfCustomers>0){
+		const unsigned count=std::min(block, numberOfCustomers);
+		const unsigned char* b=read(3*count);
+		for (unsigned i = 0; i < count; i++, b+=12) {
+			Entity c;
+			c.id=customers.size()+1;	//+1 because 0 is depot
+			c.type=EnityType::CUSTOMER;
+			c.p.x=number(b);
+			c.p.y=number(b+4);
+			c.quantity=number(b+8);
+			customers.push_back(c);
+		}
+		numberOfCustomers-=count;
+	}
+}
+
+VRP VRP::subProblem(const std::vector<unsigned>& ids) const{
+	VRP sub;
+	sub.vehicleCapacity=vehicleCapacity;
+	sub.maxRouteTime=maxRouteTime;
+	sub.dropTime=dropTime;
+	sub.depot=depot;
+
+	sub.customers.reserve(ids.size());
+	for(unsigned id : ids){
+		if(id==0 || id>customers.size())
+			throw std::runtime_error("VRP: invalid customer id in sub problem.");
+		Entity c=customers[id-1];
+		c.id=sub.customers.size()+1;	//+1 because 0 is depot
+		sub.customers.push_back(c);
+	}
+	return sub;
+}
+
 /*** End of file: VRP.cpp ***/
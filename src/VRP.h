@@ -11,6 +11,7 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <cstdint>
 /**
  * Structure for coordinates.
  */
@@ -44,7 +45,11 @@ public:
 	VRP(){};
 
 	/**
-	 * Loads VRP from the stream.
+	 * Loads VRP from the stream. Stream can be in text format (the same as benchmarks in folder solve)
+	 * or in binary format (stream starts with BINARY_MAGIC). All numbers of binary format are
+	 * 32 bit unsigned integers in little endian:
+	 * 	magic, version, number of customers, vehicle capacity, maximum route time, drop time,
+	 * 	depot x, depot y and x, y, quantity of every customer.
 	 *
 	 * @param[in] input
 	 * 	The VRP.
@@ -52,6 +57,20 @@ public:
 	 */
 	VRP(std::istream& input);
 
+	static constexpr std::uint32_t BINARY_MAGIC=0x42505256;	//! Bytes "VRPB" in little endian.
+	static constexpr std::uint32_t BINARY_VERSION=1;	//! Version of binary format.
+
+	/**
+	 * Creates problem with the same depot and vehicles, but only with some customers.
+	 * Customers of sub problem are numbered from one in the given order.
+	 *
+	 * @param[in] ids
+	 * 	Ids of customers of this problem that are in the sub problem.
+	 * @return Sub problem.
+	 * @throw std::runtime_error	Invalid customer id.
+	 */
+	VRP subProblem(const std::vector<unsigned>& ids) const;
+
 	const std::vector<Entity>& getCustomers() const {
 		return customers;
 	}
@@ -89,6 +108,15 @@ public:
 	}
 
 private:
+	/**
+	 * Loads VRP in binary format.
+	 *
+	 * @param[in] input
+	 * 	Stream at start of the binary format.
+	 * @throw std::runtime_error on invalid input
+	 */
+	void loadBinary(std::istream& input);
+
 	unsigned vehicleCapacity=0;
 	unsigned maxRouteTime=0;
 	unsigned dropTime=0;
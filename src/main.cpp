@@ -8,8 +8,51 @@
 #include <iostream>
 #include <fstream>
 #include <exception>
+#include <string>
+#include <cstdlib>
+#include <csignal>
+#include <atomic>
 #include "VRP.h"
 #include "ACO.h"
+#include "Decomposition.h"
+
+/**
+ * Set by SIGINT. Solver stops and prints the best solution so far.
+ */
+static std::atomic<bool> interrupted(false);
+
+static void onInterrupt(int){
+	interrupted=true;
+}
+
+/**
+ * Prints usage of the program.
+ *
+ * @param[in] name
+ * 	Name of the program.
+ */
+static void usage(const char* name){
+	std::cerr << "Usage: " << name << " [options] PATH_TO_PROBLEM\n"
+			<< "\t-i N\tnumber of iterations (default 2n)\n"
+			<< "\t-t SEC\ttime limit in seconds\n"
+			<< "\t-s SEED\tseed of random generators (default random)\n"
+			<< "\t-p SEC\tminimal seconds between progress reports (default 0)\n"
+			<< "\t-g\tants are creating giant tour that is split to routes\n"
+			<< "\t-k N\tlocal search improves only N best constructed solutions (default 0, all)\n"
+			<< "\t-f P\tprobability that local search improves all solutions of iteration\n"
+			<< "\t-n N\tlocal search improves all solutions after N iterations without improvement\n"
+			<< "\t-w N\tasynchronous colony with N worker threads (default 0, synchronous)\n"
+			<< "\t-l\tsolve only with Clarke-Wright savings (milliseconds)\n"
+			<< "\t-o\tcolony starts from savings solution with pheromone scaled by its cost\n"
+			<< "\t-a K\tpopulation based colony with archive of K solutions (default 0, pheromone of all arcs)\n"
+			<< "\t-b X\tpheromone is reinitialized when mean lambda-branching factor drops below X (default 0, never)\n"
+			<< "\t-e N\troutes with at most N (at most 16) customers are optimized exactly (default 9, 0 only 2-opt)\n"
+			<< "\t-c N\tdecomposition to clusters with N customers solved by independent colonies\n"
+			<< "\t-m\tk-means clustering for decomposition (default sweep)\n"
+			<< "\t-r N\trounds of decomposition (default 3)\n"
+			<< "\t-j N\tthreads solving clusters of decomposition (default number of CPUs)\n"
+			<< "\t-q\tdo not print progress" << std::endl;
+}
 
 /**
  * Entry point of the program.
@@ -22,14 +65,77 @@
  */
 int main(int argc, char* argv[]){
 	try{
-		if(argc!=2){
+		SolveOptions options;
+		options.progressInterval=0;
+		bool quiet=false;
+		bool giantTour=false;
+		bool savingsOnly=false;
+		bool savingsStart=false;
+		unsigned localSearchAnts=0;
+		double fullSweepProbability=0;
+		unsigned stagnationSweep=0;
+		unsigned asyncWorkers=0;
+		unsigned exactRouteSize=9;
+		unsigned population=0;
+		double restartBranching=0;
+		unsigned clusterSize=0;
+		unsigned rounds=3;
+		unsigned clusterWorkers=0;
+		Decomposition::Clustering clustering=Decomposition::Clustering::SWEEP;
+		const char* path=nullptr;
+
+		for(int a=1; a<argc; a++){
+			std::string arg(argv[a]);
+			if(arg=="-q"){
+				quiet=true;
+			}else if(arg=="-g"){
+				giantTour=true;
+			}else if(arg=="-l"){
+				savingsOnly=true;
+			}else if(arg=="-o"){
+				savingsStart=true;
+			}else if(arg=="-m"){
+				clustering=Decomposition::Clustering::KMEANS;
+			}else if((arg=="-i" || arg=="-t" || arg=="-s" || arg=="-p" || arg=="-k" || arg=="-f" || arg=="-n" || arg=="-w" || arg=="-e"
+					|| arg=="-a" || arg=="-b" || arg=="-c" || arg=="-r" || arg=="-j") && a+1<argc){
+				const char* value=argv[++a];
+				if(arg=="-i") options.iterations=std::strtoul(value, nullptr, 10);
+				else if(arg=="-k") localSearchAnts=std::strtoul(value, nullptr, 10);
+				else if(arg=="-f") fullSweepProbability=std::strtod(value, nullptr);
+				else if(arg=="-n") stagnationSweep=std::strtoul(value, nullptr, 10);
+				else if(arg=="-w") asyncWorkers=std::strtoul(value, nullptr, 10);
+				else if(arg=="-e") exactRouteSize=std::strtoul(value, nullptr, 10);
+				else if(arg=="-a") population=std::strtoul(value, nullptr, 10);
+				else if(arg=="-b") restartBranching=std::strtod(value, nullptr);
+				else if(arg=="-c") clusterSize=std::strtoul(value, nullptr, 10);
+				else if(arg=="-r") rounds=std::strtoul(value, nullptr, 10);
+				else if(arg=="-j") clusterWorkers=std::strtoul(value, nullptr, 10);
+				else if(arg=="-t") options.timeLimit=std::strtod(value, nullptr);
+				else if(arg=="-s") options.seed=std::strtoul(value, nullptr, 10);
+				else options.progressInterval=std::strtod(value, nullptr);
+			}else if(path==nullptr && (arg.empty() || arg[0]!='-')){
+				path=argv[a];
+			}else{
+				usage(argv[0]);
+				return 1;
+			}
+		}
+
+		if(exactRouteSize>ACO::MAX_EXACT_ROUTE_SIZE){
+			std::cerr << "Routes with at most " << ACO::MAX_EXACT_ROUTE_SIZE << " customers can be optimized exactly." << std::endl;
+			usage(argv[0]);
+			return 1;
+		}
+
+		if(path==nullptr){
 			std::cerr << "This program is expecting one argument with file containing problem to solve." << std::endl;
+			usage(argv[0]);
 			return 1;
 		}
 
-		std::ifstream file(argv[1]);
+		std::ifstream file(path, std::ios::binary);
 		if(!file){
-			std::cerr << "Can not open "<< argv[1] << " for reading."<< std::endl;
+			std::cerr << "Can not open "<< path << " for reading."<< std::endl;
 			return 2;
 		}
 
@@ -42,14 +148,71 @@ int main(int argc, char* argv[]){
 		}
 
 		//init solver
-		ACO aco(vrp);
-		aco.solve(2*vrp.getCustomers().size()); //according to paper 2n iteration
+		auto setup=[&](ACO& aco){
+			if(giantTour) aco.setGiantTour(true);
+			aco.setLocalSearchAnts(localSearchAnts);
+			aco.setFullSweepProbability(fullSweepProbability);
+			aco.setStagnationSweep(stagnationSweep);
+			aco.setAsyncWorkers(asyncWorkers);
+			aco.setExactRouteSize(exactRouteSize);
+			aco.setPopulation(population);
+			aco.setRestartBranching(restartBranching);
+			aco.setSavingsStart(savingsStart);
+		};
+
+		if(!quiet){
+			options.progress=[](const SolveProgress& p){
+				std::cout << p.iteration << ". ITER best so far: " << p.bestCost << " time: " << p.elapsed << "\n";
+			};
+		}
+		options.cancel=&interrupted;
+		std::signal(SIGINT, onInterrupt);
 
-		auto s=aco.getBestSoFar();
-		for(auto v: s.second){
-			std::cout << v->c->id << "\t";
+		SolveResult result;
+		if(savingsOnly){
+			ACO aco(vrp);
+			setup(aco);
+			result=aco.solveSavings();
+		}else if(clusterSize>0){
+			//big problem is solved by parts
+			Decomposition decomposition(vrp);
+			decomposition.setClustering(clustering);
+			decomposition.setClusterSize(clusterSize);
+			decomposition.setRounds(rounds);
+			decomposition.setWorkers(clusterWorkers);
+			decomposition.setColonySetup(setup);
+			result=decomposition.solve(options);
+		}else{
+			ACO aco(vrp);
+			setup(aco);
+			result=aco.solve(options); //by default according to paper 2n iteration
 		}
-		std::cout << "\n" << s.first << std::endl;
+
+		if(result.routes.empty()){
+			//solving was stopped (Ctrl+C or time limit) before the first solution was constructed
+			std::cerr << "No solution was found before solving was stopped." << std::endl;
+			return 5;
+		}
+
+		for(const std::vector<unsigned>& r : result.routes){
+			std::cout << 0 << "\t";
+			for(unsigned c : r) std::cout << c << "\t";
+		}
+		std::cout << 0 << "\t";
+		std::cout << "\n" << result.cost << std::endl;
+
+		#ifdef PRINT_STATS
+		const SolveStats& stats=result.stats;
+		std::cerr << "iterations: " << result.iterations << " time: " << result.elapsed << " s" << std::endl;
+		std::cerr << "constructions: " << stats.constructions << " candidates rejected by late return to depot: " << stats.lateReturns << std::endl;
+		std::cerr << "improved solutions: " << stats.localSearchSolutions << " full sweeps: " << stats.fullSweeps << std::endl;
+		std::cerr << "routes: " << result.routes.size() << " nearest feasible fallbacks: " << stats.nearestFallbacks << std::endl;
+		std::cerr << "pheromone restarts: " << stats.restarts << std::endl;
+		std::cerr << "route cache hits: " << stats.routeCacheHits << " misses: " << stats.routeCacheMisses
+				<< " hit rate: " << (stats.routeCacheHits+stats.routeCacheMisses>0 ?
+						100.0*stats.routeCacheHits/(stats.routeCacheHits+stats.routeCacheMisses) : 0) << " %" << std::endl;
+		std::cerr << "local search time: " << stats.localSearchTime << " s saved (estimate): " << stats.localSearchTimeSaved << " s" << std::endl;
+		#endif
 
 	}catch (const std::exception& e) {
 		std::cerr << "Error:\n\t"<< e.what() << std::endl;
@@ -0,0 +1,311 @@
+/**
+ * Project: VRPAntColony
+ * @file vrpd.cpp
+ * @date 18. 10. 2026
+ * @author xdocek09
+ * @brief Daemon that solves vehicle routing problems received over Unix domain socket (or stdin).
+ */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "VRP.h"
+#include "ACO.h"
+#include "Protocol.h"
+
+/**
+ * Set by SIGINT or SIGTERM. Running solving is cancelled and daemon ends.
+ */
+static std::atomic<bool> stopping(false);
+
+static void onStop(int){
+	stopping=true;
+}
+
+/**
+ * One client. Responses of its requests are written by workers in order of completion.
+ */
+class Connection{
+public:
+	Connection(const int in, const int out, const bool owned) :in(in), out(out), owned(owned) {}
+
+	~Connection(){
+		if(owned) close(in);
+	}
+
+	/**
+	 * Writes response. Responses from different workers are not mixed.
+	 *
+	 * @param[in] response
+	 * 	Response for writing.
+	 */
+	void respond(const std::string& response){
+		std::lock_guard<std::mutex> guard(writeLock);
+		writeAll(out, response);
+	}
+
+	const int in;	//! descriptor for reading requests
+	const int out;	//! descriptor for writing responses
+
+private:
+	const bool owned;	//! descriptor is closed with the connection
+	std::mutex writeLock;
+};
+
+/**
+ * Request waiting for worker.
+ */
+struct Job{
+	std::shared_ptr<Connection> connection;
+	SolveRequest request;
+};
+
+/**
+ * Queue with limited size. Producers are blocked when it is full.
+ */
+class JobQueue{
+public:
+	JobQueue(const std::size_t capacity) :capacity(capacity) {}
+
+	/**
+	 * Inserts job. Waits when queue is full.
+	 *
+	 * @param[in] job
+	 * 	Job for insertion.
+	 * @return False when queue is closed.
+	 */
+	bool push(Job&& job){
+		std::unique_lock<std::mutex> lock(m);
+		notFull.wait(lock, [this](){ return closed || jobs.size()<capacity; });
+		if(closed) return false;
+		jobs.push_back(std::move(job));
+		notEmpty.notify_one();
+		return true;
+	}
+
+	/**
+	 * Takes job. Waits when queue is empty.
+	 *
+	 * @param[out] job
+	 * 	Taken job.
+	 * @return False when queue is closed and empty.
+	 */
+	bool pop(Job& job){
+		std::unique_lock<std::mutex> lock(m);
+		notEmpty.wait(lock, [this](){ return closed || !jobs.empty(); });
+		if(jobs.empty()) return false;
+		job=std::move(jobs.front());
+		jobs.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	/**
+	 * Wakes all waiting threads. Remaining jobs can still be taken.
+	 */
+	void close(){
+		std::lock_guard<std::mutex> guard(m);
+		closed=true;
+		notEmpty.notify_all();
+		notFull.notify_all();
+	}
+
+private:
+	const std::size_t capacity;
+	std::deque<Job> jobs;
+	bool closed=false;
+	std::mutex m;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+};
+
+/**
+ * Solves jobs from queue. Every worker has its own solver whose buffers are reused between jobs.
+ *
+ * @param[in] queue
+ * 	Source of jobs.
+ */
+static void worker(JobQueue& queue){
+	ACO aco;
+	Job job;
+	while(queue.pop(job)){
+		if(stopping){
+			//daemon ends, waiting jobs are not solved
+			job.connection->respond(formatError(job.request.id, "cancelled"));
+			job=Job();
+			continue;
+		}
+		try{
+			std::istringstream input(job.request.problem);
+			VRP vrp(input);
+			if(vrp.getCustomers().size()==0) throw std::runtime_error("No customers to visit.");
+
+			aco.load(vrp);
+			SolveOptions options;
+			options.iterations=job.request.iterations;
+			options.timeLimit=job.request.timeLimit;
+			options.seed=job.request.seed;
+			options.cancel=&stopping;
+			const SolveResult result=aco.solve(options);
+			if(result.cancelled){
+				//best solution so far is not the answer for requested iterations
+				job.connection->respond(formatError(job.request.id, "cancelled"));
+			}else if(result.routes.empty()){
+				job.connection->respond(formatError(job.request.id, "No solution was found within time limit."));
+			}else{
+				job.connection->respond(formatResult(job.request.id, result));
+			}
+		}catch(const std::exception& e){
+			job.connection->respond(formatError(job.request.id, e.what()));
+		}
+		job=Job();	//release the connection
+	}
+}
+
+/**
+ * Reads requests of one client and inserts them to queue.
+ *
+ * @param[in] connection
+ * 	Client connection.
+ * @param[in] queue
+ * 	Queue for jobs. It is shared, because readers are not joined.
+ * @param[in] maxCustomers
+ * 	Maximal number of customers of one problem.
+ */
+static void reader(std::shared_ptr<Connection> connection, std::shared_ptr<JobQueue> queue,
+		const unsigned long maxCustomers){
+	FdReader input(connection->in);
+	while(!stopping){
+		Job job;
+		try{
+			if(!readRequest(input, job.request, maxCustomers)) break;
+		}catch(const std::exception& e){
+			//we can not find the start of the next request
+			connection->respond(formatError(job.request.id, e.what()));
+			break;
+		}
+		job.connection=connection;
+		if(!queue->push(std::move(job))) break;
+	}
+}
+
+/**
+ * Prints usage of the program.
+ *
+ * @param[in] name
+ * 	Name of the program.
+ */
+static void usage(const char* name){
+	std::cerr << "Usage: " << name << " [-w WORKERS] [-q QUEUE] [-m CUSTOMERS] SOCKET_PATH|-\n"
+			<< "\t-w N\tnumber of solving threads (default number of CPUs)\n"
+			<< "\t-q N\tmaximal number of waiting requests (default 2*WORKERS)\n"
+			<< "\t-m N\tmaximal number of customers of one problem (default " << DEFAULT_MAX_CUSTOMERS << ")\n"
+			<< "\t-\tread requests from stdin and write responses to stdout" << std::endl;
+}
+
+/**
+ * Entry point of the daemon.
+ *
+ * @param[in] argc
+ * 	Number of arguments.
+ * @param[in] argv
+ * 	Arguments.
+ * @return Exits codes.
+ */
+int main(int argc, char* argv[]){
+	unsigned workers=std::thread::hardware_concurrency();
+	if(workers==0) workers=1;
+	unsigned long queueSize=0;
+	unsigned long maxCustomers=DEFAULT_MAX_CUSTOMERS;
+	const char* path=nullptr;
+
+	for(int a=1; a<argc; a++){
+		std::string arg(argv[a]);
+		if((arg=="-w" || arg=="-q" || arg=="-m") && a+1<argc){
+			unsigned long value=std::strtoul(argv[++a], nullptr, 10);
+			if(arg=="-w") workers=value;
+			else if(arg=="-m") maxCustomers=value;
+			else queueSize=value;
+		}else if(path==nullptr && (arg=="-" || arg[0]!='-')){
+			path=argv[a];
+		}else{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if(path==nullptr || workers==0){
+		usage(argv[0]);
+		return 1;
+	}
+	if(queueSize==0) queueSize=2*workers;
+
+	//without SA_RESTART blocking accept is interrupted by the signal
+	struct sigaction sa;
+	std::memset(&sa, 0, sizeof(sa));
+	sa.sa_handler=onStop;
+	sigaction(SIGINT, &sa, nullptr);
+	sigaction(SIGTERM, &sa, nullptr);
+	std::signal(SIGPIPE, SIG_IGN);
+
+	int listening=-1;
+	if(std::string(path)!="-"){
+		sockaddr_un addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sun_family=AF_UNIX;
+		if(std::strlen(path)>=sizeof(addr.sun_path)){
+			std::cerr << "Socket path is too long." << std::endl;
+			return 2;
+		}
+		std::strcpy(addr.sun_path, path);
+		unlink(path);
+
+		listening=socket(AF_UNIX, SOCK_STREAM, 0);
+		if(listening<0 || bind(listening, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))<0
+				|| listen(listening, 128)<0){
+			std::cerr << "Can not listen on " << path << ": " << std::strerror(errno) << std::endl;
+			return 2;
+		}
+	}
+
+	std::shared_ptr<JobQueue> queue=std::make_shared<JobQueue>(queueSize);
+	std::vector<std::thread> pool;
+	for(unsigned w=0; w<workers; w++) pool.push_back(std::thread(worker, std::ref(*queue)));
+
+	if(listening<0){
+		//one client on standard input and output
+		reader(std::make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false), queue, maxCustomers);
+	}else{
+		while(!stopping){
+			int client=accept(listening, nullptr, nullptr);
+			if(client<0){
+				if(errno==EINTR) continue;
+				std::cerr << "Accept failed: " << std::strerror(errno) << std::endl;
+				break;
+			}
+			//readers are blocked on their clients, so they are not joined
+			std::thread(reader, std::make_shared<Connection>(client, client, true), queue, maxCustomers).detach();
+		}
+		close(listening);
+		unlink(path);
+	}
+
+	queue->close();
+	for(std::thread& t : pool) t.join();
+	return 0;
+}
+
+/*** End of file: vrpd.cpp ***/
@@ -0,0 +1,22 @@
+#!/bin/sh
+# throughput of asynchronous colony: constructed solutions per second (median of 3 runs of 5 s)
+# with N worker threads (0 is synchronous colony), results are in exp/async/throughput.txt
+make clean
+make vrpStats
+
+mkdir -p exp/async
+out=exp/async/throughput.txt
+echo "# problem workers constructions_per_second (CPUs: $(nproc))" > "$out"
+for i in 1 12; do
+  for w in 0 1 2 4 8; do
+    rate=$(for r in 1 2 3; do
+      ./vrp -w "$w" -t 5 -i 1000000 -s "$r" -q "./solve/vrpnc$i.txt" 2>&1 |
+        awk '/^iterations/ { t=$4 } /^constructions/ { c=$2 } END { printf "%.0f\n", c/t }'
+    done | sort -n | sed -n 2p)
+    echo "vrpnc$i $w $rate" >> "$out"
+  done
+done
+cat "$out"
+
+make clean
+make
@@ -0,0 +1,28 @@
+#!/bin/sh
+# binary format: the same generated problem in text and binary format must give the same savings solution,
+# truncated binary file must be rejected
+make clean
+make
+make bench
+
+status=0
+text=$(mktemp)
+binary=$(mktemp)
+for layout in uniform clustered mixed; do
+  ./vrpgen -n 5000 -l "$layout" -T 1.5 -r 10 -s 7 -o "$text"
+  ./vrpgen -n 5000 -l "$layout" -T 1.5 -r 10 -s 7 -b -o "$binary"
+  a=$(./vrp -l -q "$text" | tail -n 1)
+  b=$(./vrp -l -q "$binary" | tail -n 1)
+  if [ -z "$a" ] || [ "$a" != "$b" ]; then
+    echo "$layout: text format costs $a, binary format costs $b"
+    status=1
+  fi
+done
+
+head -c 1000 "$binary" > "$text"
+if ./vrp -l -q "$text" > /dev/null 2>&1; then
+  echo "truncated binary file was accepted"
+  status=1
+fi
+rm -f "$text" "$binary"
+exit $status
@@ -0,0 +1,15 @@
+#!/bin/sh
+# decomposition: solutions joined from clusters must be feasible and visit every customer
+make clean
+make
+
+status=0
+for i in 11 12 13 14; do
+  for clustering in "" "-m"; do
+    if ! ./vrp -c 50 $clustering -i 20 -s 1 -q "./solve/vrpnc$i.txt" | exp/check.py "./solve/vrpnc$i.txt" > /dev/null; then
+      echo "vrpnc$i: decomposition -c 50 $clustering is not feasible"
+      status=1
+    fi
+  done
+done
+exit $status
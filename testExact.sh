@@ -0,0 +1,25 @@
+#!/bin/sh
+# exact optimization of short routes (-e): routes must have optimal order (so no 2-opt order is better)
+# and in the first iteration (the same routes are constructed) the best solution must not be worse than with 2-opt
+make clean
+make
+
+status=0
+for i in 1 6 12; do
+  exact=$(./vrp -i 1 -e 9 -s 1 -q "./solve/vrpnc$i.txt" | exp/check.py --exact 9 "./solve/vrpnc$i.txt")
+  twoOpt=$(./vrp -i 1 -e 0 -s 1 -q "./solve/vrpnc$i.txt" | exp/check.py "./solve/vrpnc$i.txt")
+  if [ -z "$exact" ] || [ -z "$twoOpt" ]; then
+    echo "vrpnc$i: routes of -e 9 are not optimal or solution is not feasible"
+    status=1
+  elif ! awk -v a="$exact" -v b="$twoOpt" 'BEGIN { exit !(a<=b) }'; then
+    echo "vrpnc$i: -e 9 costs $exact, -e 0 costs $twoOpt"
+    status=1
+  fi
+done
+
+# bigger tables
+if ! ./vrp -i 20 -e 12 -s 1 -q "./solve/vrpnc1.txt" | exp/check.py --exact 12 "./solve/vrpnc1.txt" > /dev/null; then
+  echo "vrpnc1: routes of -e 12 are not optimal"
+  status=1
+fi
+exit $status
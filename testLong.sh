@@ -0,0 +1,13 @@
+#!/bin/sh
+make clean
+make
+
+# long runs, choice info of arcs without deposits underflows to zero
+status=0
+for s in $(seq 1 3); do
+  if ! ./vrp -i 750 -s "$s" -q "./solve/vrpnc2.txt" > /dev/null; then
+    echo "vrpnc2 with 750 iterations and seed $s failed"
+    status=1
+  fi
+done
+exit $status
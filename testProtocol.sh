@@ -0,0 +1,45 @@
+#!/bin/sh
+# protocol of vrpd over standard input: results, rejected headers and cancelled requests
+make clean
+make
+
+status=0
+fail(){
+  echo "$1"
+  status=1
+}
+
+# result is the same as result of vrp with the same seed and its routes are feasible
+expected=$(./vrp -i 50 -s 1 -q ./solve/vrpnc1.txt | tail -n 1)
+response=$( (echo "SOLVE first 50 0 1"; cat ./solve/vrpnc1.txt) | ./vrpd -w 1 -)
+echo "$response" | head -n 1 | grep -q "^RESULT first " || fail "valid request: $response"
+cost=$(echo "$response" | head -n 1 | cut -d ' ' -f 3)
+if ! printf "%s\n%s\n" "$(echo "$response" | tail -n 1)" "$cost" | exp/check.py ./solve/vrpnc1.txt > /dev/null; then
+  fail "valid request: routes are not feasible"
+fi
+awk -v a="$cost" -v b="$expected" 'BEGIN { d=a-b; if (d<0) d=-d; exit !(d<=1e-5*b) }' \
+  || fail "valid request: cost $cost differs from vrp $expected"
+
+# invalid fields of header are rejected with id of request
+for header in "SOLVE neg -1" "SOLVE text x" "SOLVE time 5 -2" "SOLVE seed 5 1 -3" "SOLVE extra 5 1 3 9" "SOLVE big 99999999999"; do
+  id=$(echo "$header" | cut -d ' ' -f 2)
+  response=$( (echo "$header"; cat ./solve/vrpnc1.txt) | ./vrpd -w 1 -)
+  echo "$response" | head -n 1 | grep -q "^ERROR $id$" || fail "header $header: $response"
+done
+
+# too many customers
+response=$( (echo "SOLVE many 5"; cat ./solve/vrpnc1.txt) | ./vrpd -w 1 -m 10 -)
+echo "$response" | head -n 1 | grep -q "^ERROR many$" || fail "too many customers: $response"
+
+# SIGTERM cancels running request and waiting requests are not solved
+out=$(mktemp)
+(for i in 1 2 3; do echo "SOLVE long$i 1000000 0 1"; cat ./solve/vrpnc1.txt; done) | ./vrpd -w 1 - > "$out" &
+pid=$!
+sleep 1
+kill -TERM $pid
+wait $pid
+[ "$(grep -c '^ERROR long[123]$' "$out")" -eq 3 ] || fail "cancelled requests: $(cat "$out")"
+[ "$(grep -c '^cancelled$' "$out")" -eq 3 ] || fail "cancelled requests: $(cat "$out")"
+rm -f "$out"
+
+exit $status
@@ -0,0 +1,23 @@
+#!/bin/sh
+# giant tour: without local search the routes must be the best split of their tour,
+# with local search they must be still feasible
+status=0
+
+make clean
+make vrpW2O
+for i in $(seq 1 14); do
+  if ! ./vrp -g -i 20 -s 1 -q "./solve/vrpnc$i.txt" | exp/check.py --split "./solve/vrpnc$i.txt" > /dev/null; then
+    echo "vrpnc$i: giant tour is not split optimally"
+    status=1
+  fi
+done
+
+make clean
+make
+for i in $(seq 1 14); do
+  if ! ./vrp -g -i 20 -s 1 -q "./solve/vrpnc$i.txt" | exp/check.py "./solve/vrpnc$i.txt" > /dev/null; then
+    echo "vrpnc$i: giant tour with local search is not feasible"
+    status=1
+  fi
+done
+exit $status